@@ -0,0 +1,127 @@
+// Converts logs/ArkApi_<pid>.blog files written with Logging.BinaryLogOutput = "File" into text.
+// Doesn't depend on Windows, build with:
+//   g++ -std=c++17 -O2 -I../../version/Core/Public/Logger BinaryLogDecoder.cpp -o BinaryLogDecoder
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BinaryLogFormat.h"
+
+namespace
+{
+	const char* level_names[] = {"trace", "debug", "info", "warning", "error", "critical", "off"};
+
+	std::string FormatTime(int64_t time_ns)
+	{
+		const time_t seconds = static_cast<time_t>(time_ns / 1000000000);
+		const int millis = static_cast<int>(time_ns / 1000000 % 1000);
+
+		tm tm{};
+		gmtime_r(&seconds, &tm);
+
+		char buffer[64];
+		const size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+		snprintf(buffer + length, sizeof(buffer) - length, ".%03d", millis);
+
+		return buffer;
+	}
+
+	bool Decode(const std::string& data, std::ostream& out)
+	{
+		using namespace API::BinaryLogFormat;
+
+		if (data.size() < sizeof(file_magic) || data.compare(0, sizeof(file_magic), file_magic, sizeof(file_magic)) != 0)
+		{
+			std::cerr << "Not a binary log file\n";
+			return false;
+		}
+
+		std::unordered_map<uint32_t, FormatInfo> formats;
+		std::vector<Arg> args;
+
+		Reader file(data.data() + sizeof(file_magic), data.size() - sizeof(file_magic));
+
+		while (!file.AtEnd())
+		{
+			RecordType type;
+			std::string payload;
+			if (!file.Read(type) || !file.ReadString(payload))
+			{
+				// Last record may be incomplete if the server crashed while writing it
+				std::cerr << "Truncated record at the end of the file\n";
+				break;
+			}
+
+			Reader reader(payload.data(), payload.size());
+
+			if (type == RecordType::Format)
+			{
+				FormatInfo info;
+				if (ReadFormatInfo(reader, info))
+				{
+					formats[info.id] = std::move(info);
+				}
+
+				continue;
+			}
+
+			uint32_t format_id;
+			uint32_t thread_id;
+			int64_t time_ns;
+			if (type != RecordType::Message || !reader.Read(format_id) || !reader.Read(thread_id)
+				|| !reader.Read(time_ns) || !ReadArgs(reader, args))
+			{
+				std::cerr << "Skipped malformed record\n";
+				continue;
+			}
+
+			const auto iter = formats.find(format_id);
+			if (iter == formats.end())
+			{
+				std::cerr << "Skipped message with unknown format " << format_id << '\n';
+				continue;
+			}
+
+			const FormatInfo& format = iter->second;
+			const char* level = format.level < std::size(level_names) ? level_names[format.level] : "?";
+
+			out << FormatTime(time_ns) << " [" << format.logger << "][" << level << "][" << thread_id << "] "
+				<< FormatText(format.format, args) << '\n';
+		}
+
+		return true;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.blog> [output.log]\n";
+		return 1;
+	}
+
+	std::ifstream input(argv[1], std::ios::binary);
+	if (!input.is_open())
+	{
+		std::cerr << "Failed to open " << argv[1] << '\n';
+		return 1;
+	}
+
+	const std::string data{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+
+	if (argc > 2)
+	{
+		std::ofstream output(argv[2]);
+		return Decode(data, output) ? 0 : 1;
+	}
+
+	return Decode(data, std::cout) ? 0 : 1;
+}
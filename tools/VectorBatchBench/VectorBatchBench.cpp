@@ -0,0 +1,241 @@
+// Times the SSE2 kernels of VectorBatch.h against their scalar versions on random positions and checks that
+// both produce the same results. Doesn't depend on Windows, build with:
+//   g++ -std=c++17 -O2 -I../../version/Core/Public/API/UE/Math VectorBatchBench.cpp -o VectorBatchBench
+// Add -DVECTOR_BATCH_SCALAR to compare the scalar path with itself
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#define VECTOR_BATCH_STANDALONE
+#define FORCEINLINE inline
+
+struct FVector
+{
+	float X;
+	float Y;
+	float Z;
+};
+
+#include "VectorBatch.h"
+
+namespace
+{
+	using namespace API;
+
+	// Every kernel runs this many times, the fastest run is reported
+	constexpr int runs = 50;
+
+	// Nearest-k has no scalar version, it is compared with a sort of all distances
+	constexpr size_t nearest_k = 16;
+
+	struct Positions
+	{
+		std::vector<float> xs;
+		std::vector<float> ys;
+		std::vector<float> zs;
+	};
+
+	Positions MakePositions(size_t count, unsigned seed)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> horizontal(-400000.f, 400000.f);
+		std::uniform_real_distribution<float> vertical(-20000.f, 20000.f);
+
+		Positions positions;
+		positions.xs.resize(count);
+		positions.ys.resize(count);
+		positions.zs.resize(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			positions.xs[i] = horizontal(generator);
+			positions.ys[i] = horizontal(generator);
+			positions.zs[i] = vertical(generator);
+		}
+
+		return positions;
+	}
+
+	template <typename Func>
+	double BestTimeMs(Func&& func)
+	{
+		double best = 0;
+		for (int run = 0; run < runs; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			func();
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+			if (run == 0 || elapsed.count() < best)
+			{
+				best = elapsed.count();
+			}
+		}
+
+		return best;
+	}
+
+	template <typename T>
+	bool SameBits(const std::vector<T>& a, const std::vector<T>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+	}
+
+	bool Report(const char* kernel, double scalar_ms, double batch_ms, bool equal)
+	{
+		std::printf("%-22s %10.3f %10.3f %8.2fx  %s\n", kernel, scalar_ms, batch_ms, scalar_ms / batch_ms,
+		            equal ? "ok" : "MISMATCH");
+		return equal;
+	}
+
+	bool Run(size_t count)
+	{
+		const Positions positions = MakePositions(count, 1);
+		const float* xs = positions.xs.data();
+		const float* ys = positions.ys.data();
+		const float* zs = positions.zs.data();
+
+		const FVector center{12345.f, -54321.f, 100.f};
+		const FVector box_min{-100000.f, -150000.f, -5000.f};
+		const FVector box_max{120000.f, 50000.f, 8000.f};
+		const float max_distance = 150000.f;
+
+		bool all_equal = true;
+
+#ifdef VECTOR_BATCH_SSE2
+		std::printf("Path: SSE2, %zu positions, best of %d runs\n", count, runs);
+#else
+		std::printf("Path: scalar (VECTOR_BATCH_SCALAR), %zu positions, best of %d runs\n", count, runs);
+#endif
+		std::printf("%-22s %10s %10s %9s\n", "Kernel", "Scalar ms", "Batch ms", "Speedup");
+
+		{
+			std::vector<float> scalar(count), batch(count);
+
+			const double scalar_ms = BestTimeMs([&] { VectorBatch::Scalar::DistanceSquared(xs, ys, zs, count, center,
+			                                                                                scalar.data()); });
+			const double batch_ms = BestTimeMs([&] { VectorBatch::DistanceSquared(xs, ys, zs, count, center,
+			                                                                       batch.data()); });
+
+			all_equal &= Report("DistanceSquared", scalar_ms, batch_ms, SameBits(scalar, batch));
+		}
+
+		{
+			std::vector<uint32_t> scalar(count), batch(count);
+			size_t scalar_found = 0, batch_found = 0;
+
+			const double scalar_ms = BestTimeMs([&]
+			{
+				scalar_found = VectorBatch::Scalar::FilterWithinDistance(xs, ys, zs, count, center, max_distance,
+				                                                         scalar.data());
+			});
+			const double batch_ms = BestTimeMs([&]
+			{
+				batch_found = VectorBatch::FilterWithinDistance(xs, ys, zs, count, center, max_distance, batch.data());
+			});
+
+			scalar.resize(scalar_found);
+			batch.resize(batch_found);
+			all_equal &= Report("FilterWithinDistance", scalar_ms, batch_ms, scalar == batch);
+		}
+
+		{
+			std::vector<uint32_t> scalar(count), batch(count);
+			size_t scalar_found = 0, batch_found = 0;
+
+			const double scalar_ms = BestTimeMs([&]
+			{
+				scalar_found = VectorBatch::Scalar::FilterInBox(xs, ys, zs, count, box_min, box_max, scalar.data());
+			});
+			const double batch_ms = BestTimeMs([&]
+			{
+				batch_found = VectorBatch::FilterInBox(xs, ys, zs, count, box_min, box_max, batch.data());
+			});
+
+			scalar.resize(scalar_found);
+			batch.resize(batch_found);
+			all_equal &= Report("FilterInBox", scalar_ms, batch_ms, scalar == batch);
+		}
+
+		{
+			std::vector<float> distances(count);
+			std::vector<uint32_t> order(count);
+			std::vector<float> reference(nearest_k);
+
+			const double scalar_ms = BestTimeMs([&]
+			{
+				VectorBatch::Scalar::DistanceSquared(xs, ys, zs, count, center, distances.data());
+				std::iota(order.begin(), order.end(), 0);
+
+				const size_t k = (std::min)(nearest_k, count);
+				std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](uint32_t a, uint32_t b)
+				{
+					return distances[a] < distances[b];
+				});
+
+				reference.resize(k);
+				for (size_t i = 0; i < k; ++i)
+				{
+					reference[i] = distances[order[i]];
+				}
+			});
+
+			std::vector<uint32_t> indices(nearest_k);
+			std::vector<float> batch(nearest_k);
+
+			const double batch_ms = BestTimeMs([&]
+			{
+				batch.resize(VectorBatch::NearestK(xs, ys, zs, count, center, nearest_k, indices.data(), batch.data()));
+			});
+
+			// Ties may pick different indices, the distances must match
+			all_equal &= Report("NearestK", scalar_ms, batch_ms, SameBits(reference, batch));
+		}
+
+		{
+			const auto transform = VectorBatch::MakeMapCoordsTransform(0.f, 0.f, 0.f, 0.f);
+			std::vector<float> scalar_x(count), scalar_y(count), batch_x(count), batch_y(count);
+
+			const double scalar_ms = BestTimeMs([&]
+			{
+				VectorBatch::Scalar::ToMapCoords(transform, xs, ys, count, scalar_x.data(), scalar_y.data());
+			});
+			const double batch_ms = BestTimeMs([&]
+			{
+				VectorBatch::ToMapCoords(transform, xs, ys, count, batch_x.data(), batch_y.data());
+			});
+
+			all_equal &= Report("ToMapCoords", scalar_ms, batch_ms,
+			                    SameBits(scalar_x, batch_x) && SameBits(scalar_y, batch_y));
+		}
+
+		return all_equal;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	size_t count = 100000;
+
+	if (argc > 1)
+	{
+		try
+		{
+			count = std::stoul(argv[1]);
+		}
+		catch (const std::exception&)
+		{
+			std::cerr << "Usage: " << argv[0] << " [position count]\n";
+			return 1;
+		}
+	}
+
+	return Run(count) ? 0 : 1;
+}
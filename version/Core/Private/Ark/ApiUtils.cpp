@@ -51,12 +51,25 @@ namespace ArkApi
 		if (!player_controller)
 			return;
 
-		const uint64 steam_id = ArkApi::IApiUtils::GetSteamIdFromController(player_controller);
+		API::PlayerIndex<AShooterPlayerController>::Keys keys;
+		keys.steam_id = ArkApi::IApiUtils::GetSteamIdFromController(player_controller);
 
-		if (steam_id != 0)
+		if (keys.steam_id == 0)
+			return;
+
+		keys.player_id = ArkApi::IApiUtils::GetPlayerID(player_controller);
+		keys.tribe_id = player_controller->TargetingTeamField();
+
+		if (player_controller->PlayerStateField())
 		{
-			steam_id_map_[steam_id] = player_controller;
+			const FString steam_name = ArkApi::IApiUtils::GetSteamName(player_controller);
+			keys.steam_name.assign(*steam_name, steam_name.Len());
+
+			const FString character_name = ArkApi::IApiUtils::GetCharacterName(player_controller);
+			keys.character_name.assign(*character_name, character_name.Len());
 		}
+
+		player_index_.Set(player_controller, std::move(keys));
 	}
 
 	void ApiUtils::RemovePlayerController(AShooterPlayerController* player_controller)
@@ -64,30 +77,83 @@ namespace ArkApi
 		if (!player_controller)
 			return;
 
-		const uint64 steam_id = ArkApi::IApiUtils::GetSteamIdFromController(player_controller);
+		player_index_.Remove(player_controller);
+	}
 
-		if (steam_id != 0)
+	void ApiUtils::RefreshPlayerController(AController* controller)
+	{
+		auto* player_controller = static_cast<AShooterPlayerController*>(controller);
+
+		if (player_controller && player_index_.Find(player_controller))
 		{
-			steam_id_map_.erase(steam_id);
+			SetPlayerController(player_controller);
 		}
 	}
 
 	AShooterPlayerController* ApiUtils::FindPlayerFromSteamId_Internal(uint64 steam_id) const
 	{
-		AShooterPlayerController* found_player = nullptr;
-
 		if (steam_id == 0)
-			return found_player;
+			return nullptr;
 
-		auto iter = steam_id_map_.find(steam_id);
+		return player_index_.FindBySteamId(steam_id);
+	}
 
-		if (iter != steam_id_map_.end()
-			&& iter->first == steam_id)
+	AShooterPlayerController* ApiUtils::FindPlayerFromSteamName_Internal(const FString& steam_name) const
+	{
+		return player_index_.FindBySteamName(std::wstring_view(*steam_name, steam_name.Len()));
+	}
+
+	AShooterPlayerController* ApiUtils::FindPlayerFromPlayerId_Internal(uint64 player_id) const
+	{
+		if (player_id == 0)
+			return nullptr;
+
+		return player_index_.FindByPlayerId(player_id);
+	}
+
+	TArray<AShooterPlayerController*> ApiUtils::FindPlayerFromCharacterName_Internal(const FString& character_name,
+	                                                                                 ESearchCase::Type search,
+	                                                                                 bool full_match) const
+	{
+		TArray<AShooterPlayerController*> found_players;
+
+		const std::wstring_view name(*character_name, character_name.Len());
+
+		player_index_.ForEachByCharacterName(name, full_match, [&](AShooterPlayerController* player_controller,
+		                                                           const auto& keys)
 		{
-			found_player = iter->second;
-		}
+			if (keys.character_name.empty())
+				return;
 
-		return found_player;
+			// The index is case-folded, exact case is checked on the candidates
+			if (search == ESearchCase::CaseSensitive
+				&& keys.character_name.compare(0, full_match ? std::wstring::npos : name.size(), name) != 0)
+				return;
+
+			found_players.Add(player_controller);
+		});
+
+		return found_players;
+	}
+
+	TArray<AShooterPlayerController*> ApiUtils::FindPlayersFromTribeId_Internal(int tribe_id) const
+	{
+		TArray<AShooterPlayerController*> found_players;
+
+		player_index_.ForEachByTribeId(tribe_id, [&](AShooterPlayerController* player_controller, const auto&)
+		{
+			found_players.Add(player_controller);
+		});
+
+		return found_players;
+	}
+
+	uint64 ApiUtils::GetSteamIDForPlayerID_Internal(uint64 player_id) const
+	{
+		AShooterPlayerController* player_controller = FindPlayerFromPlayerId_Internal(player_id);
+
+		const auto* keys = player_controller ? player_index_.Find(player_controller) : nullptr;
+		return keys ? keys->steam_id : 0;
 	}
 
 	UShooterCheatManager* ApiUtils::GetCheatManager() const
@@ -95,6 +161,159 @@ namespace ArkApi
 		return cheatmanager_;
 	}
 
+	// Broadcasts
+
+	template <typename Func>
+	void ApiUtils::ForEachInAudience(const ArkApi::BroadcastAudience& audience, Func&& func) const
+	{
+		using Type = ArkApi::BroadcastAudience::Type;
+
+		switch (audience.type)
+		{
+		case Type::Tribe:
+			player_index_.ForEachByTribeId(audience.tribe_id, [&](AShooterPlayerController* player_controller,
+			                                                      const auto& keys)
+			{
+				func(player_controller, keys.steam_id);
+			});
+			break;
+		case Type::SteamIds:
+			for (const uint64 steam_id : audience.steam_ids)
+			{
+				AShooterPlayerController* player_controller = player_index_.FindBySteamId(steam_id);
+				if (player_controller)
+				{
+					func(player_controller, steam_id);
+				}
+			}
+			break;
+		default:
+			player_index_.ForEach([&](AShooterPlayerController* player_controller, const auto& keys)
+			{
+				bool matches = true;
+
+				switch (audience.type)
+				{
+				case Type::Radius:
+					matches = FVector::DistSquared(player_controller->DefaultActorLocationField(), audience.location)
+						<= audience.radius * audience.radius;
+					break;
+				case Type::Admins:
+					matches = player_controller->bIsAdmin()();
+					break;
+				case Type::Predicate:
+					matches = audience.predicate && audience.predicate(player_controller);
+					break;
+				default:
+					break;
+				}
+
+				if (matches)
+				{
+					func(player_controller, keys.steam_id);
+				}
+			});
+			break;
+		}
+	}
+
+	TArray<AShooterPlayerController*> ApiUtils::GetAudience_Internal(const ArkApi::BroadcastAudience& audience) const
+	{
+		TArray<AShooterPlayerController*> players;
+
+		ForEachInAudience(audience, [&](AShooterPlayerController* player_controller, uint64)
+		{
+			players.Add(player_controller);
+		});
+
+		return players;
+	}
+
+	void ApiUtils::Broadcast_Internal(const ArkApi::BroadcastAudience& audience, ArkApi::BroadcastMessage message,
+	                                  size_t batch_size)
+	{
+		if (batch_size == 0)
+		{
+			ForEachInAudience(audience, [&](AShooterPlayerController* player_controller, uint64)
+			{
+				SendBroadcastMessage(player_controller, message);
+			});
+
+			return;
+		}
+
+		PendingBroadcast broadcast;
+		broadcast.message = std::move(message);
+		broadcast.batch_size = batch_size;
+
+		ForEachInAudience(audience, [&](AShooterPlayerController*, uint64 steam_id)
+		{
+			broadcast.steam_ids.push_back(steam_id);
+		});
+
+		// First batch goes out right away, the rest on the next frames
+		if (SendBroadcastBatch(broadcast))
+			return;
+
+		pending_broadcasts_.push_back(std::move(broadcast));
+
+		if (!broadcast_tick_registered_)
+		{
+			broadcast_tick_registered_ = true;
+			API::game_api->GetCommands()->AddOnTickCallback("ApiBroadcast", std::bind(&ApiUtils::ProcessBroadcasts, this));
+		}
+	}
+
+	void ApiUtils::SendBroadcastMessage(AShooterPlayerController* player_controller, ArkApi::BroadcastMessage& message)
+	{
+		switch (message.type)
+		{
+		case ArkApi::BroadcastMessage::Type::ServerMessage:
+			player_controller->ClientServerChatDirectMessage(&message.text, message.color, false);
+			break;
+		case ArkApi::BroadcastMessage::Type::Notification:
+			player_controller->ClientServerSOTFNotificationCustom(&message.text, message.color, message.display_scale,
+			                                                      message.display_time, message.icon, nullptr);
+			break;
+		case ArkApi::BroadcastMessage::Type::Chat:
+			player_controller->ClientChatMessage(message.chat_message);
+			break;
+		}
+	}
+
+	bool ApiUtils::SendBroadcastBatch(PendingBroadcast& broadcast)
+	{
+		const size_t end = (std::min)(broadcast.next + broadcast.batch_size, broadcast.steam_ids.size());
+
+		for (; broadcast.next < end; ++broadcast.next)
+		{
+			// Players who left since the broadcast was queued are skipped
+			AShooterPlayerController* player_controller = player_index_.FindBySteamId(
+				broadcast.steam_ids[broadcast.next]);
+			if (player_controller)
+			{
+				SendBroadcastMessage(player_controller, broadcast.message);
+			}
+		}
+
+		return broadcast.next >= broadcast.steam_ids.size();
+	}
+
+	void ApiUtils::ProcessBroadcasts()
+	{
+		for (auto iter = pending_broadcasts_.begin(); iter != pending_broadcasts_.end();)
+		{
+			if (SendBroadcastBatch(*iter))
+			{
+				iter = pending_broadcasts_.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
 	// Free function
 	IApiUtils& GetApiUtils()
 	{
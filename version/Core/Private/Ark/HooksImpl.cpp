@@ -7,7 +7,13 @@
 #include "../IBaseApi.h"
 #include <../Private/Ark/Globals.h>
 
+#include <ActorRegistry.h>
+#include <BlueprintCache.h>
+#include <Config.h>
+#include <FlightRecorder.h>
+#include <InventoryIndex.h>
 #include <Logger/Logger.h>
+#include <ObjectNameIndex.h>
 
 namespace ArkApi
 {
@@ -27,6 +33,17 @@ namespace ArkApi
 	DECLARE_HOOK(APlayerController_ServerReceivedPlayerControllerAck_Implementation, void, APlayerController*);
 	DECLARE_HOOK(AShooterPlayerController_Possess, void, AShooterPlayerController*, APawn*);
 	DECLARE_HOOK(AShooterGameMode_Logout, void, AShooterGameMode*, AController*);
+	DECLARE_HOOK(APlayerState_SetPlayerName, void, APlayerState*, FString*);
+	DECLARE_HOOK(AShooterCharacter_RenamePlayer_Implementation, void, AShooterCharacter*, FString*);
+	DECLARE_HOOK(AShooterPlayerState_AddToTribe, bool, AShooterPlayerState*, FTribeData*, bool, bool, bool,
+		APlayerController*);
+	DECLARE_HOOK(AShooterPlayerState_ClearTribe, void, AShooterPlayerState*, bool, bool, APlayerController*);
+	DECLARE_HOOK(AActor_BeginPlay, void, AActor*);
+	DECLARE_HOOK(AActor_Destroyed, void, AActor*);
+	DECLARE_HOOK(UPrimalInventoryComponent_NotifyItemAdded, void, UPrimalInventoryComponent*, UPrimalItem*, bool);
+	DECLARE_HOOK(UPrimalInventoryComponent_NotifyItemRemoved, void, UPrimalInventoryComponent*, UPrimalItem*);
+	DECLARE_HOOK(UPrimalInventoryComponent_NotifyItemQuantityUpdated, void, UPrimalInventoryComponent*, UPrimalItem*,
+		int);
 
 	void InitHooks()
 	{
@@ -55,6 +72,23 @@ namespace ArkApi
 		hooks->SetHook("AShooterPlayerController.Possess", &Hook_AShooterPlayerController_Possess,
 			&AShooterPlayerController_Possess_original);
 		hooks->SetHook("AShooterGameMode.Logout", &Hook_AShooterGameMode_Logout, &AShooterGameMode_Logout_original);
+		hooks->SetHook("APlayerState.SetPlayerName", &Hook_APlayerState_SetPlayerName,
+			&APlayerState_SetPlayerName_original);
+		hooks->SetHook("AShooterCharacter.RenamePlayer_Implementation", &Hook_AShooterCharacter_RenamePlayer_Implementation,
+			&AShooterCharacter_RenamePlayer_Implementation_original);
+		hooks->SetHook("AShooterPlayerState.AddToTribe", &Hook_AShooterPlayerState_AddToTribe,
+			&AShooterPlayerState_AddToTribe_original);
+		hooks->SetHook("AShooterPlayerState.ClearTribe", &Hook_AShooterPlayerState_ClearTribe,
+			&AShooterPlayerState_ClearTribe_original);
+		hooks->SetHook("AActor.BeginPlay", &Hook_AActor_BeginPlay, &AActor_BeginPlay_original);
+		hooks->SetHook("AActor.Destroyed", &Hook_AActor_Destroyed, &AActor_Destroyed_original);
+		hooks->SetHook("UPrimalInventoryComponent.NotifyItemAdded", &Hook_UPrimalInventoryComponent_NotifyItemAdded,
+			&UPrimalInventoryComponent_NotifyItemAdded_original);
+		hooks->SetHook("UPrimalInventoryComponent.NotifyItemRemoved", &Hook_UPrimalInventoryComponent_NotifyItemRemoved,
+			&UPrimalInventoryComponent_NotifyItemRemoved_original);
+		hooks->SetHook("UPrimalInventoryComponent.NotifyItemQuantityUpdated",
+			&Hook_UPrimalInventoryComponent_NotifyItemQuantityUpdated,
+			&UPrimalInventoryComponent_NotifyItemQuantityUpdated_original);
 
 		Log::GetLog()->info("Initialized hooks\n");
 	}
@@ -63,9 +97,15 @@ namespace ArkApi
 
 	void Hook_UEngine_Init(DWORD64 _this, DWORD64 InEngineLoop)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "UEngine::Init");
+
 		UEngine_Init_original(_this, InEngineLoop);
 
 		Log::GetLog()->info("UGameEngine::Init was called");
+
+		// Config files are read from DllMain, the watcher thread can only start now
+		API::Config::Get().StartWatcher();
+
 		Log::GetLog()->info("Loading plugins..\n");
 
 		API::PluginManager::Get().LoadAllPlugins();
@@ -75,6 +115,8 @@ namespace ArkApi
 
 	void Hook_UWorld_InitWorld(UWorld* world, DWORD64 ivs)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "UWorld::InitWorld");
+
 		Log::GetLog()->info("UWorld::InitWorld was called");
 
 		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetWorld(world);
@@ -96,6 +138,8 @@ namespace ArkApi
 	void Hook_AShooterGameMode_InitGame(AShooterGameMode* a_shooter_game_mode, FString* map_name, FString* options,
 		FString* error_message)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "AShooterGameMode::InitGame");
+
 		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetShooterGameMode(a_shooter_game_mode);
 
 		AShooterGameMode_InitGame_original(a_shooter_game_mode, map_name, options, error_message);
@@ -172,13 +216,21 @@ namespace ArkApi
 
 	void Hook_AShooterGameMode_BeginPlay(AShooterGameMode* _AShooterGameMode)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "AShooterGameMode::BeginPlay");
+
 		AShooterGameMode_BeginPlay_original(_AShooterGameMode);
 
 		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetStatus(ServerStatus::Ready);
+
+		API::BlueprintCache::Get().OnServerReady();
+		API::ObjectNameIndex::Get().Start();
+		API::ActorRegistry::Get().OnServerReady();
 	}
 
 	bool Hook_URCONServer_Init(URCONServer* _this, FString Password, int InPort, UShooterCheatManager* SCheatManager)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "URCONServer::Init");
+
 		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetCheatManager(SCheatManager);
 
 		return URCONServer_Init_original(_this, Password, InPort, SCheatManager);
@@ -186,6 +238,8 @@ namespace ArkApi
 
 	void Hook_APlayerController_ServerReceivedPlayerControllerAck_Implementation(APlayerController* _this)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "APlayerController::ServerReceivedPlayerControllerAck");
+
 		APlayerController_ServerReceivedPlayerControllerAck_Implementation_original(_this);
 
 		if (_this)
@@ -197,16 +251,97 @@ namespace ArkApi
 
 	void  Hook_AShooterPlayerController_Possess(AShooterPlayerController* _this, APawn* inPawn)
 	{
-		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetPlayerController(_this);
-
 		AShooterPlayerController_Possess_original(_this, inPawn);
+
+		// After the original, so the index gets the name of the possessed character
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetPlayerController(_this);
 	}
 
 	void  Hook_AShooterGameMode_Logout(AShooterGameMode* _this, AController* Exiting)
 	{
+		API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Hook, "AShooterGameMode::Logout");
+
 		AShooterPlayerController* Exiting_SPC = static_cast<AShooterPlayerController*>(Exiting);
 		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RemovePlayerController(Exiting_SPC);
 
 		AShooterGameMode_Logout_original(_this, Exiting);
 	}
+
+	// Player index updates
+
+	void Hook_APlayerState_SetPlayerName(APlayerState* _this, FString* S)
+	{
+		APlayerState_SetPlayerName_original(_this, S);
+
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RefreshPlayerController(
+			static_cast<AController*>(_this->OwnerField()));
+	}
+
+	void Hook_AShooterCharacter_RenamePlayer_Implementation(AShooterCharacter* _this, FString* NewName)
+	{
+		AShooterCharacter_RenamePlayer_Implementation_original(_this, NewName);
+
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RefreshPlayerController(_this->ControllerField());
+	}
+
+	bool Hook_AShooterPlayerState_AddToTribe(AShooterPlayerState* _this, FTribeData* MyNewTribe, bool bMergeTribe,
+		bool bForce, bool bIsFromInvite, APlayerController* InviterPC)
+	{
+		const bool result = AShooterPlayerState_AddToTribe_original(_this, MyNewTribe, bMergeTribe, bForce,
+			bIsFromInvite, InviterPC);
+
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RefreshPlayerController(
+			static_cast<AController*>(_this->OwnerField()));
+
+		return result;
+	}
+
+	void Hook_AShooterPlayerState_ClearTribe(AShooterPlayerState* _this, bool bDontRemoveFromTribe, bool bForce,
+		APlayerController* ForPC)
+	{
+		AShooterPlayerState_ClearTribe_original(_this, bDontRemoveFromTribe, bForce, ForPC);
+
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RefreshPlayerController(
+			static_cast<AController*>(_this->OwnerField()));
+	}
+
+	void Hook_AActor_BeginPlay(AActor* _this)
+	{
+		AActor_BeginPlay_original(_this);
+
+		API::ActorRegistry::Get().OnBeginPlay(_this);
+	}
+
+	void Hook_AActor_Destroyed(AActor* _this)
+	{
+		API::ActorRegistry::Get().OnDestroyed(_this);
+
+		AActor_Destroyed_original(_this);
+	}
+
+	void Hook_UPrimalInventoryComponent_NotifyItemAdded(UPrimalInventoryComponent* _this, UPrimalItem* theItem,
+		bool bEquippedItem)
+	{
+		UPrimalInventoryComponent_NotifyItemAdded_original(_this, theItem, bEquippedItem);
+
+		if (!bEquippedItem)
+		{
+			API::InventoryIndex::Get().OnItemAdded(_this, theItem);
+		}
+	}
+
+	void Hook_UPrimalInventoryComponent_NotifyItemRemoved(UPrimalInventoryComponent* _this, UPrimalItem* theItem)
+	{
+		API::InventoryIndex::Get().OnItemRemoved(_this, theItem);
+
+		UPrimalInventoryComponent_NotifyItemRemoved_original(_this, theItem);
+	}
+
+	void Hook_UPrimalInventoryComponent_NotifyItemQuantityUpdated(UPrimalInventoryComponent* _this,
+		UPrimalItem* anItem, int amount)
+	{
+		UPrimalInventoryComponent_NotifyItemQuantityUpdated_original(_this, anItem, amount);
+
+		API::InventoryIndex::Get().OnItemQuantityUpdated(_this, anItem);
+	}
 } // namespace ArkApi
\ No newline at end of file
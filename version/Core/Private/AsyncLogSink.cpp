@@ -0,0 +1,265 @@
+#include "AsyncLogSink.h"
+
+#include <chrono>
+#include <thread>
+
+namespace API
+{
+	// Longest time spdlog's flush waits for the worker, e.g. after an error when flush_on is set
+	constexpr auto sink_flush_timeout = std::chrono::milliseconds(1000);
+
+	namespace
+	{
+		size_t GetQueueCapacity(size_t queue_size)
+		{
+			size_t capacity = 2;
+			while (capacity < queue_size)
+			{
+				capacity <<= 1;
+			}
+
+			return capacity;
+		}
+	} // namespace
+
+	AsyncLogPipeline::AsyncLogPipeline(const AsyncLogSettings& settings)
+		: settings_(settings),
+		  queue_(GetQueueCapacity(settings.queue_size))
+	{
+	}
+
+	spdlog::sink_ptr AsyncLogPipeline::Wrap(spdlog::sink_ptr target)
+	{
+		targets_.push_back(target);
+		return std::make_shared<AsyncLogSink>(shared_from_this(), std::move(target));
+	}
+
+	void AsyncLogPipeline::Start()
+	{
+		std::thread([self = shared_from_this()] { self->Run(); }).detach();
+	}
+
+	void AsyncLogPipeline::Push(spdlog::sinks::sink* target, const spdlog::details::log_msg& msg)
+	{
+		Entry entry;
+		entry.target = target;
+		entry.level = msg.level;
+		entry.time = msg.time;
+		entry.thread_id = msg.thread_id;
+		entry.logger_name = *msg.logger_name;
+		entry.text.assign(msg.formatted.data(), msg.formatted.size());
+
+		// enqueue moves the entry only on success
+		switch (settings_.overflow_policy)
+		{
+		case LogOverflowPolicy::Block:
+			while (!queue_.enqueue(std::move(entry)))
+			{
+				std::this_thread::yield();
+			}
+			break;
+		case LogOverflowPolicy::Drop:
+			if (!queue_.enqueue(std::move(entry)))
+			{
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			break;
+		case LogOverflowPolicy::DropOldest:
+			while (!queue_.enqueue(std::move(entry)))
+			{
+				Entry oldest;
+				if (queue_.dequeue(oldest))
+				{
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					processed_.fetch_add(1, std::memory_order_release);
+				}
+			}
+			break;
+		}
+
+		pushed_.fetch_add(1, std::memory_order_release);
+
+		if (sleeping_.load())
+		{
+			wake_.notify_one();
+		}
+	}
+
+	bool AsyncLogPipeline::Flush(std::chrono::milliseconds timeout)
+	{
+		const uint64_t target = pushed_.load(std::memory_order_acquire);
+
+		if (std::this_thread::get_id() != worker_id_.load())
+		{
+			flush_requests_.fetch_add(1);
+
+			// Polls instead of waiting on a condition variable, crash handlers call this as well
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (flushed_.load(std::memory_order_acquire) < target && std::chrono::steady_clock::now() < deadline)
+			{
+				wake_.notify_one();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			flush_requests_.fetch_sub(1);
+
+			if (flushed_.load(std::memory_order_acquire) >= target)
+			{
+				return true;
+			}
+		}
+
+		Entry entry;
+		while (queue_.dequeue(entry))
+		{
+			Write(entry);
+			processed_.fetch_add(1, std::memory_order_release);
+		}
+
+		FlushTargets();
+
+		return flushed_.load(std::memory_order_acquire) >= target;
+	}
+
+	void AsyncLogPipeline::Run()
+	{
+		using Clock = std::chrono::steady_clock;
+
+		worker_id_.store(std::this_thread::get_id());
+
+		const auto flush_interval = std::chrono::milliseconds(settings_.flush_interval_ms);
+
+		auto last_flush = Clock::now();
+		bool unflushed = false;
+		size_t reported_dropped = 0;
+
+		Entry entry;
+
+		while (true)
+		{
+			if (queue_.dequeue(entry))
+			{
+				Write(entry);
+				processed_.fetch_add(1, std::memory_order_release);
+				unflushed = true;
+
+				// Errors are written out right away, they often come shortly before a crash
+				if (entry.level >= spdlog::level::err || Clock::now() - last_flush >= flush_interval)
+				{
+					FlushTargets();
+					last_flush = Clock::now();
+					unflushed = false;
+				}
+
+				continue;
+			}
+
+			const size_t dropped = dropped_.load(std::memory_order_relaxed);
+			if (dropped != reported_dropped)
+			{
+				WriteDroppedSummary(dropped - reported_dropped);
+				reported_dropped = dropped;
+				unflushed = true;
+			}
+
+			// Flush() waits for the queue to drain, messages discarded by DropOldest count as written
+			const bool flush_requested = flush_requests_.load() > 0 &&
+				flushed_.load(std::memory_order_relaxed) != processed_.load(std::memory_order_relaxed);
+
+			if (flush_requested || (unflushed && Clock::now() - last_flush >= flush_interval))
+			{
+				FlushTargets();
+				last_flush = Clock::now();
+				unflushed = false;
+			}
+
+			// Producers only notify while the worker sleeps, a missed notification costs one timeout at most
+			sleeping_.store(true);
+			if (queue_.is_empty())
+			{
+				std::unique_lock<std::mutex> lock(wake_mutex_);
+				wake_.wait_for(lock, std::chrono::milliseconds(10));
+			}
+			sleeping_.store(false);
+		}
+	}
+
+	void AsyncLogPipeline::Write(const Entry& entry)
+	{
+		spdlog::details::log_msg msg(&entry.logger_name, entry.level);
+		msg.time = entry.time;
+		msg.thread_id = entry.thread_id;
+		msg.formatted << entry.text;
+
+		try
+		{
+			if (entry.target->should_log(entry.level))
+			{
+				entry.target->log(msg);
+			}
+		}
+		catch (const std::exception&)
+		{
+		}
+	}
+
+	void AsyncLogPipeline::WriteDroppedSummary(size_t count)
+	{
+		static const std::string logger_name = "API";
+		static spdlog::pattern_formatter formatter("%D %R [%n][%l] %v");
+
+		spdlog::details::log_msg msg(&logger_name, spdlog::level::warn);
+		msg.raw << "Log queue overflow, dropped " << count << " messages";
+		formatter.format(msg);
+
+		for (const auto& target : targets_)
+		{
+			try
+			{
+				target->log(msg);
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+	}
+
+	void AsyncLogPipeline::FlushTargets()
+	{
+		const uint64_t processed = processed_.load(std::memory_order_acquire);
+
+		for (const auto& target : targets_)
+		{
+			try
+			{
+				target->flush();
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+
+		// Flush() may run on another thread at the same time, the count never goes back
+		uint64_t flushed = flushed_.load(std::memory_order_relaxed);
+		while (flushed < processed && !flushed_.compare_exchange_weak(flushed, processed, std::memory_order_release))
+		{
+		}
+	}
+
+	AsyncLogSink::AsyncLogSink(std::shared_ptr<AsyncLogPipeline> pipeline, spdlog::sink_ptr target)
+		: pipeline_(std::move(pipeline)),
+		  target_(std::move(target))
+	{
+	}
+
+	void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+	{
+		pipeline_->Push(target_.get(), msg);
+	}
+
+	void AsyncLogSink::flush()
+	{
+		pipeline_->Flush(sink_flush_timeout);
+	}
+} // namespace API
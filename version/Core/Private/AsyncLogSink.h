@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Logger/Logger.h>
+#include <Logger/spdlog/details/mpmc_bounded_q.h>
+
+namespace API
+{
+	enum class LogOverflowPolicy
+	{
+		// Caller waits until the worker makes room
+		Block,
+		// New message is discarded
+		Drop,
+		// Oldest queued message is discarded to make room for the new one
+		DropOldest
+	};
+
+	struct AsyncLogSettings
+	{
+		// Rounded up to a power of two
+		size_t queue_size{8192};
+		LogOverflowPolicy overflow_policy{LogOverflowPolicy::Block};
+		int flush_interval_ms{1000};
+	};
+
+	/**
+	 * \brief Single background writer shared by all API and plugin loggers.
+	 * Callers only copy the formatted line into a lock-free queue
+	 */
+	class AsyncLogPipeline : public std::enable_shared_from_this<AsyncLogPipeline>
+	{
+	public:
+		explicit AsyncLogPipeline(const AsyncLogSettings& settings);
+
+		AsyncLogPipeline(const AsyncLogPipeline&) = delete;
+		AsyncLogPipeline(AsyncLogPipeline&&) = delete;
+		AsyncLogPipeline& operator=(const AsyncLogPipeline&) = delete;
+		AsyncLogPipeline& operator=(AsyncLogPipeline&&) = delete;
+
+		/**
+		 * \brief Wraps the sink so messages for it go through the queue
+		 */
+		spdlog::sink_ptr Wrap(spdlog::sink_ptr target);
+
+		/**
+		 * \brief Starts the worker thread. The thread keeps the pipeline alive until the process exits
+		 */
+		void Start();
+
+		void Push(spdlog::sinks::sink* target, const spdlog::details::log_msg& msg);
+
+		/**
+		 * \brief Waits until messages queued before the call are written and the sinks are flushed.
+		 * If the worker doesn't finish within the timeout, e.g. because its thread is gone at process exit,
+		 * or the caller is the worker itself, the rest of the queue is written on the calling thread
+		 * \return true if everything queued before the call was written
+		 */
+		bool Flush(std::chrono::milliseconds timeout);
+
+		size_t GetDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+	private:
+		struct Entry
+		{
+			spdlog::sinks::sink* target{nullptr};
+			spdlog::level::level_enum level{spdlog::level::info};
+			spdlog::log_clock::time_point time;
+			size_t thread_id{0};
+			std::string logger_name;
+			std::string text;
+		};
+
+		void Run();
+		void Write(const Entry& entry);
+		void WriteDroppedSummary(size_t count);
+		void FlushTargets();
+
+		AsyncLogSettings settings_;
+		spdlog::details::mpmc_bounded_queue<Entry> queue_;
+		std::vector<spdlog::sink_ptr> targets_;
+
+		std::atomic<size_t> dropped_{0};
+
+		// Entries enqueued, entries written or discarded, and entries written before the last flush of the sinks
+		std::atomic<uint64_t> pushed_{0};
+		std::atomic<uint64_t> processed_{0};
+		std::atomic<uint64_t> flushed_{0};
+		std::atomic<int> flush_requests_{0};
+		std::atomic<std::thread::id> worker_id_;
+
+		std::atomic<bool> sleeping_{false};
+		std::mutex wake_mutex_;
+		std::condition_variable wake_;
+	};
+
+	class AsyncLogSink : public spdlog::sinks::sink
+	{
+	public:
+		AsyncLogSink(std::shared_ptr<AsyncLogPipeline> pipeline, spdlog::sink_ptr target);
+
+		void log(const spdlog::details::log_msg& msg) override;
+
+		/**
+		 * \brief Waits until the worker has written everything queued so far and flushed the sinks
+		 */
+		void flush() override;
+
+	private:
+		std::shared_ptr<AsyncLogPipeline> pipeline_;
+		spdlog::sink_ptr target_;
+	};
+} // namespace API
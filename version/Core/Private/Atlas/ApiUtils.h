@@ -1,7 +1,11 @@
 #pragma once
 
+#include <list>
+
 #include <IApiUtils.h>
 
+#include "../PlayerIndex.h"
+
 namespace AtlasApi
 {
 	class ApiUtils : public ArkApi::IApiUtils
@@ -27,14 +31,48 @@ namespace AtlasApi
 		void SetCheatManager(UShooterCheatManager* cheatmanager);
 
 		AShooterPlayerController* FindPlayerFromSteamId_Internal(uint64 steam_id) const override;
+		AShooterPlayerController* FindPlayerFromSteamName_Internal(const FString& steam_name) const override;
+		AShooterPlayerController* FindPlayerFromPlayerId_Internal(uint64 player_id) const override;
+		TArray<AShooterPlayerController*> FindPlayerFromCharacterName_Internal(const FString& character_name,
+		                                                                      ESearchCase::Type search,
+		                                                                      bool full_match) const override;
+		TArray<AShooterPlayerController*> FindPlayersFromTribeId_Internal(int tribe_id) const override;
+		uint64 GetSteamIDForPlayerID_Internal(uint64 player_id) const override;
+		TArray<AShooterPlayerController*> GetAudience_Internal(const ArkApi::BroadcastAudience& audience) const override;
+		void Broadcast_Internal(const ArkApi::BroadcastAudience& audience, ArkApi::BroadcastMessage message,
+		                        size_t batch_size) override;
+
 		void SetPlayerController(AShooterPlayerController* player_controller);
 		void RemovePlayerController(AShooterPlayerController* player_controller);
 
+		/**
+		 * \brief Re-reads names and tribe of an indexed player after they have changed
+		 */
+		void RefreshPlayerController(AController* controller);
+
 	private:
+		struct PendingBroadcast
+		{
+			ArkApi::BroadcastMessage message;
+			std::vector<uint64> steam_ids;
+			size_t next{0};
+			size_t batch_size{0};
+		};
+
+		template <typename Func>
+		void ForEachInAudience(const ArkApi::BroadcastAudience& audience, Func&& func) const;
+
+		static void SendBroadcastMessage(AShooterPlayerController* player_controller,
+		                                 ArkApi::BroadcastMessage& message);
+		bool SendBroadcastBatch(PendingBroadcast& broadcast);
+		void ProcessBroadcasts();
+
 		UWorld* u_world_{nullptr};
 		AShooterGameMode* shooter_game_mode_{nullptr};
 		ArkApi::ServerStatus status_{0};
 		UShooterCheatManager* cheatmanager_{ nullptr };
-		std::unordered_map<uint64, AShooterPlayerController*> steam_id_map_;
+		API::PlayerIndex<AShooterPlayerController> player_index_;
+		std::list<PendingBroadcast> pending_broadcasts_;
+		bool broadcast_tick_registered_{false};
 	};
 } // namespace AtlasApi
@@ -1,12 +1,15 @@
 #include "AtlasBaseApi.h"
 
 #include <filesystem>
+#include <fstream>
 
+#include <FlightRecorder.h>
 #include <Tools.h>
 
 #include "../Offsets.h"
 #include "../PDBReader/PDBReader.h"
 #include "../PluginManager/PluginManager.h"
+#include "../PluginManager/PluginStats.h"
 #include "../Hooks.h"
 #include "../Commands.h"
 #include "Logger/Logger.h"
@@ -87,8 +90,14 @@ namespace API
 	{
 		GetCommands()->AddConsoleCommand("plugins.load", &LoadPluginCmd);
 		GetCommands()->AddConsoleCommand("plugins.unload", &UnloadPluginCmd);
+		GetCommands()->AddConsoleCommand("plugins.stats", &PluginsStatsCmd);
+		GetCommands()->AddConsoleCommand("api.flightrecorder", &DumpFlightRecorderCmd);
 		GetCommands()->AddRconCommand("plugins.load", &LoadPluginRcon);
 		GetCommands()->AddRconCommand("plugins.unload", &UnloadPluginRcon);
+		GetCommands()->AddRconCommand("plugins.stats", &PluginsStatsRcon);
+		GetCommands()->AddRconCommand("api.flightrecorder", &DumpFlightRecorderRcon);
+
+		GetCommands()->AddOnTimerCallback("LogRateLimitFlush", &FlushLogRateLimits);
 	}
 
 	FString AtlasBaseApi::LoadPlugin(FString* cmd)
@@ -127,9 +136,11 @@ namespace API
 		{
 			const std::string plugin_name = parsed[1].ToString();
 
+			std::vector<std::string> dependents;
+
 			try
 			{
-				PluginManager::Get().UnloadPlugin(plugin_name);
+				dependents = PluginManager::Get().UnloadPlugin(plugin_name);
 			}
 			catch (const std::exception& error)
 			{
@@ -139,12 +150,58 @@ namespace API
 
 			Log::GetLog()->info("Unloaded plugin - {}", plugin_name.c_str());
 
+			if (!dependents.empty())
+			{
+				std::string names;
+				for (const auto& dependent : dependents)
+				{
+					names += (names.empty() ? "" : ", ") + dependent;
+				}
+
+				return *FString::Format("Successfully unloaded plugin and its dependents - {}", names);
+			}
+
 			return L"Successfully unloaded plugin";
 		}
 
 		return L"Plugin not found";
 	}
 
+	FString AtlasBaseApi::PluginsStats(FString* cmd)
+	{
+		TArray<FString> parsed;
+		cmd->ParseIntoArray(parsed, L" ", true);
+
+		if (parsed.IsValidIndex(1) && parsed[1].Compare(L"json", ESearchCase::IgnoreCase) == 0)
+		{
+			const std::string path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/PluginStats.json";
+
+			std::ofstream file{path};
+			if (!file.is_open())
+			{
+				return L"Failed to write plugin stats";
+			}
+
+			file << PluginStats::Get().ToJson().dump(4);
+			file.close();
+
+			return FString::Format("Plugin stats were written to {}", path);
+		}
+
+		return FString(PluginStats::Get().ToString());
+	}
+
+	FString AtlasBaseApi::DumpFlightRecorder(FString* /*cmd*/)
+	{
+		const std::string path = FlightRecorder::Get().Dump("console command");
+		if (path.empty())
+		{
+			return L"Failed to write flight recorder";
+		}
+
+		return FString::Format("Flight recorder was written to {}", path);
+	}
+
 	// Command Callbacks
 	void AtlasBaseApi::LoadPluginCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
 	{
@@ -158,6 +215,18 @@ namespace API
 		ArkApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *UnloadPlugin(cmd));
 	}
 
+	void AtlasBaseApi::PluginsStatsCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		ArkApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *PluginsStats(cmd));
+	}
+
+	void AtlasBaseApi::DumpFlightRecorderCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		ArkApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *DumpFlightRecorder(cmd));
+	}
+
 	// RCON Command Callbacks
 	void AtlasBaseApi::LoadPluginRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
 	                                  UWorld* /*unused*/)
@@ -172,4 +241,18 @@ namespace API
 		FString reply = UnloadPlugin(&rcon_packet->Body);
 		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
 	}
+
+	void AtlasBaseApi::PluginsStatsRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = PluginsStats(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void AtlasBaseApi::DumpFlightRecorderRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = DumpFlightRecorder(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
 } // namespace API
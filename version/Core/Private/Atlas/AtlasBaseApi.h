@@ -25,14 +25,22 @@ namespace API
 		// Callbacks
 		static FString LoadPlugin(FString* cmd);
 		static FString UnloadPlugin(FString* cmd);
+		static FString PluginsStats(FString* cmd);
+		static FString DumpFlightRecorder(FString* cmd);
 
 		static void LoadPluginCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
 		static void UnloadPluginCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void PluginsStatsCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void DumpFlightRecorderCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
 
 		static void LoadPluginRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
 		                           UWorld* /*unused*/);
 		static void UnloadPluginRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
 		                             UWorld* /*unused*/);
+		static void PluginsStatsRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+		                             UWorld* /*unused*/);
+		static void DumpFlightRecorderRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+		                                   UWorld* /*unused*/);
 
 		std::unique_ptr<ArkApi::ICommands> commands_;
 		std::unique_ptr<ArkApi::IHooks> hooks_;
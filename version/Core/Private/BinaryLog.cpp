@@ -0,0 +1,298 @@
+#include <Logger/BinaryLog.h>
+
+#include <algorithm>
+#include <thread>
+
+#include <Config.h>
+#include <Tools.h>
+
+namespace API
+{
+	/**
+	 * \brief Single producer, single consumer ring of [size:u32][payload] records
+	 */
+	struct BinaryLog::ThreadBuffer
+	{
+		explicit ThreadBuffer(size_t capacity)
+			: data(capacity),
+			  mask(capacity - 1)
+		{
+		}
+
+		bool Push(const char* bytes, size_t size)
+		{
+			const size_t needed = sizeof(uint32_t) + size;
+
+			const size_t write_pos = head.load(std::memory_order_relaxed);
+			const size_t read_pos = tail.load(std::memory_order_acquire);
+			if (data.size() - (write_pos - read_pos) < needed)
+			{
+				return false;
+			}
+
+			const auto record_size = static_cast<uint32_t>(size);
+			CopyIn(write_pos, reinterpret_cast<const char*>(&record_size), sizeof(uint32_t));
+			CopyIn(write_pos + sizeof(uint32_t), bytes, size);
+
+			head.store(write_pos + needed, std::memory_order_release);
+			return true;
+		}
+
+		bool Pop(std::string& record)
+		{
+			const size_t read_pos = tail.load(std::memory_order_relaxed);
+			const size_t write_pos = head.load(std::memory_order_acquire);
+			if (read_pos == write_pos)
+			{
+				return false;
+			}
+
+			uint32_t record_size;
+			CopyOut(read_pos, reinterpret_cast<char*>(&record_size), sizeof(uint32_t));
+
+			record.resize(record_size);
+			CopyOut(read_pos + sizeof(uint32_t), record.data(), record_size);
+
+			tail.store(read_pos + sizeof(uint32_t) + record_size, std::memory_order_release);
+			return true;
+		}
+
+		bool IsEmpty() const
+		{
+			return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+		}
+
+		void CopyIn(size_t pos, const char* bytes, size_t size)
+		{
+			const size_t offset = pos & mask;
+			const size_t first = (std::min)(size, data.size() - offset);
+
+			memcpy(data.data() + offset, bytes, first);
+			memcpy(data.data(), bytes + first, size - first);
+		}
+
+		void CopyOut(size_t pos, char* bytes, size_t size) const
+		{
+			const size_t offset = pos & mask;
+			const size_t first = (std::min)(size, data.size() - offset);
+
+			memcpy(bytes, data.data() + offset, first);
+			memcpy(bytes + first, data.data(), size - first);
+		}
+
+		std::vector<char> data;
+		const size_t mask;
+
+		std::atomic<size_t> head{0};
+		std::atomic<size_t> tail{0};
+	};
+
+	BinaryLog::BinaryLog()
+	{
+		const std::string config_path = Tools::GetCurrentDir() + "/config.json";
+		auto& config = Config::Get();
+
+		const size_t buffer_size = config.GetValue<size_t>(config_path, "/settings/Logging/BinaryLogBufferSize",
+		                                                   buffer_size_);
+		while (buffer_size_ < buffer_size)
+		{
+			buffer_size_ <<= 1;
+		}
+
+		if (config.GetValue<std::string>(config_path, "/settings/Logging/BinaryLogOutput", "Text") == "File")
+		{
+			output_ = Output::File;
+
+			file_.open(Tools::GetCurrentDir() + "/logs/ArkApi_" + std::to_string(GetCurrentProcessId()) + ".blog",
+			           std::ios::binary | std::ios::trunc);
+			file_.write(BinaryLogFormat::file_magic, sizeof(BinaryLogFormat::file_magic));
+		}
+	}
+
+	BinaryLog& BinaryLog::Get()
+	{
+		static BinaryLog instance;
+		return instance;
+	}
+
+	uint32_t BinaryLog::RegisterFormat(const std::string& logger_name, spdlog::level::level_enum level,
+	                                   const char* file, int line, const char* format)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		BinaryLogFormat::FormatInfo info;
+		info.id = static_cast<uint32_t>(formats_.size());
+		info.level = static_cast<uint8_t>(level);
+		info.line = static_cast<uint32_t>(line);
+		info.logger = logger_name;
+		info.file = file;
+		info.format = format;
+
+		formats_.push_back(std::move(info));
+
+		if (!worker_started_)
+		{
+			worker_started_ = true;
+			std::thread(&BinaryLog::Run, this).detach();
+		}
+
+		return formats_.back().id;
+	}
+
+	void BinaryLog::Write(const char* data, size_t size)
+	{
+		thread_local const std::shared_ptr<ThreadBuffer> buffer = CreateThreadBuffer();
+
+		if (!buffer->Push(data, size))
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	size_t BinaryLog::GetDroppedCount() const
+	{
+		return dropped_.load(std::memory_order_relaxed);
+	}
+
+	std::shared_ptr<BinaryLog::ThreadBuffer> BinaryLog::CreateThreadBuffer()
+	{
+		auto buffer = std::make_shared<ThreadBuffer>(buffer_size_);
+
+		std::lock_guard<std::mutex> guard(mutex_);
+		buffers_.push_back(buffer);
+
+		return buffer;
+	}
+
+	void BinaryLog::Run()
+	{
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		std::string record;
+
+		while (true)
+		{
+			SyncFormats();
+
+			{
+				std::lock_guard<std::mutex> guard(mutex_);
+				buffers = buffers_;
+			}
+
+			bool processed = false;
+
+			for (const auto& buffer : buffers)
+			{
+				while (buffer->Pop(record))
+				{
+					Process(record);
+					processed = true;
+				}
+			}
+
+			buffers.clear();
+
+			{
+				// Buffers which are only referenced from here belong to exited threads
+				std::lock_guard<std::mutex> guard(mutex_);
+				buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), [](const auto& buffer)
+				{
+					return buffer.use_count() == 1 && buffer->IsEmpty();
+				}), buffers_.end());
+			}
+
+			if (processed)
+			{
+				if (file_.is_open())
+				{
+					file_.flush();
+				}
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+		}
+	}
+
+	void BinaryLog::SyncFormats()
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		for (size_t i = worker_formats_.size(); i < formats_.size(); ++i)
+		{
+			worker_formats_.push_back(formats_[i]);
+
+			if (output_ == Output::File)
+			{
+				std::string payload;
+				BinaryLogFormat::Writer writer(payload);
+				BinaryLogFormat::WriteFormatInfo(writer, formats_[i]);
+
+				WriteRecord(BinaryLogFormat::RecordType::Format, payload);
+			}
+		}
+	}
+
+	void BinaryLog::Process(const std::string& record)
+	{
+		BinaryLogFormat::Reader reader(record.data(), record.size());
+
+		uint32_t format_id;
+		uint32_t thread_id;
+		int64_t time_ns;
+		if (!reader.Read(format_id) || !reader.Read(thread_id) || !reader.Read(time_ns))
+		{
+			return;
+		}
+
+		// Call site could have been registered after the last sync
+		if (format_id >= worker_formats_.size())
+		{
+			SyncFormats();
+
+			if (format_id >= worker_formats_.size())
+			{
+				return;
+			}
+		}
+
+		if (output_ == Output::File)
+		{
+			WriteRecord(BinaryLogFormat::RecordType::Message, record);
+			return;
+		}
+
+		if (!BinaryLogFormat::ReadArgs(reader, args_))
+		{
+			return;
+		}
+
+		static spdlog::pattern_formatter formatter("%D %R [%n][%l] %v");
+
+		const auto& format = worker_formats_[format_id];
+
+		spdlog::details::log_msg msg(&format.logger, static_cast<spdlog::level::level_enum>(format.level));
+		msg.time = spdlog::log_clock::time_point(
+			std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(time_ns)));
+		msg.thread_id = thread_id;
+		msg.raw << BinaryLogFormat::FormatText(format.format, args_);
+		formatter.format(msg);
+
+		for (const auto& sink : GetLogSinks())
+		{
+			if (sink->should_log(msg.level))
+			{
+				sink->log(msg);
+			}
+		}
+	}
+
+	void BinaryLog::WriteRecord(BinaryLogFormat::RecordType type, const std::string& payload)
+	{
+		const auto size = static_cast<uint32_t>(payload.size());
+
+		file_.write(reinterpret_cast<const char*>(&type), sizeof(type));
+		file_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file_.write(payload.data(), payload.size());
+	}
+} // namespace API
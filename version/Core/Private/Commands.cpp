@@ -2,42 +2,52 @@
 
 #include "IBaseApi.h"
 
+#include <intrin.h>
+
+#pragma intrinsic(_ReturnAddress)
+
 namespace ArkApi
 {
 	void Commands::AddChatCommand(const FString& command,
 		const std::function<void(AShooterPlayerController*, FString*, EChatSendMode::Type)>&
 		callback)
 	{
-		chat_commands_.push_back(std::make_shared<ChatCommand>(command, callback));
+		chat_commands_.push_back(std::make_shared<ChatCommand>(command, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Commands::AddConsoleCommand(const FString& command,
 		const std::function<void(APlayerController*, FString*, bool)>& callback)
 	{
-		console_commands_.push_back(std::make_shared<ConsoleCommand>(command, callback));
+		console_commands_.push_back(std::make_shared<ConsoleCommand>(command, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Commands::AddRconCommand(const FString& command,
 		const std::function<void(RCONClientConnection*, RCONPacket*, UWorld*)>& callback)
 	{
-		rcon_commands_.push_back(std::make_shared<RconCommand>(command, callback));
+		rcon_commands_.push_back(std::make_shared<RconCommand>(command, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Commands::AddOnTickCallback(const FString& id, const std::function<void(float)>& callback)
 	{
-		on_tick_callbacks_.push_back(std::make_shared<OnTickCallback>(id, callback));
+		on_tick_callbacks_.push_back(std::make_shared<OnTickCallback>(id, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Commands::AddOnTimerCallback(const FString& id, const std::function<void()>& callback)
 	{
-		on_timer_callbacks_.push_back(std::make_shared<OnTimerCallback>(id, callback));
+		on_timer_callbacks_.push_back(std::make_shared<OnTimerCallback>(id, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Commands::AddOnChatMessageCallback(const FString& id,
 		const std::function<bool(AShooterPlayerController*, FString*,
 			EChatSendMode::Type, bool, bool)>& callback)
 	{
-		on_chat_message_callbacks_.push_back(std::make_shared<OnChatMessageCallback>(id, callback));
+		on_chat_message_callbacks_.push_back(std::make_shared<OnChatMessageCallback>(id, callback,
+			API::PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	bool Commands::RemoveChatCommand(const FString& command)
@@ -95,6 +105,7 @@ namespace ArkApi
 		{
 			if (data)
 			{
+				API::PluginStats::ScopedTimer timer(data->owner);
 				data->callback(delta_seconds);
 			}
 		}
@@ -107,6 +118,7 @@ namespace ArkApi
 		{
 			if (data)
 			{
+				API::PluginStats::ScopedTimer timer(data->owner);
 				data->callback();
 			}
 		}
@@ -124,12 +136,33 @@ namespace ArkApi
 		bool prevent_default = false;
 		for (const auto& data : tmp_chat_callbacks)
 		{
+			API::PluginStats::ScopedTimer timer(data->owner);
 			prevent_default |= data->callback(player_controller, message, mode, spam_check, command_executed);
 		}
 
 		return prevent_default;
 	}
 
+	void Commands::CountCommands(std::unordered_map<HMODULE, size_t>& commands,
+		std::unordered_map<HMODULE, size_t>& callbacks) const
+	{
+		const auto count = [](const auto& registrations, std::unordered_map<HMODULE, size_t>& counts)
+		{
+			for (const auto& data : registrations)
+			{
+				++counts[data->owner];
+			}
+		};
+
+		count(chat_commands_, commands);
+		count(console_commands_, commands);
+		count(rcon_commands_, commands);
+
+		count(on_tick_callbacks_, callbacks);
+		count(on_timer_callbacks_, callbacks);
+		count(on_chat_message_callbacks_, callbacks);
+	}
+
 	// Free function
 	ICommands& GetCommands()
 	{
@@ -4,9 +4,14 @@
 
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <FlightRecorder.h>
+
+#include "PluginManager/PluginStats.h"
+
 namespace ArkApi
 {
 	class Commands : public ICommands
@@ -53,18 +58,28 @@ namespace ArkApi
 		bool CheckOnChatMessageCallbacks(AShooterPlayerController* player_controller, FString* message,
 		                                 EChatSendMode::Type mode, bool spam_check, bool command_executed);
 
+		/**
+		 * \brief Counts registered commands and callbacks by the module which registered them
+		 */
+		void CountCommands(std::unordered_map<HMODULE, size_t>& commands,
+		                   std::unordered_map<HMODULE, size_t>& callbacks) const;
+
 	private:
 		template <typename T>
 		struct Command
 		{
-			Command(FString command, std::function<T> callback)
+			Command(FString command, std::function<T> callback, HMODULE owner)
 				: command(std::move(command)),
-				  callback(std::move(callback))
+				  callback(std::move(callback)),
+				  owner(owner)
 			{
 			}
 
 			FString command;
 			std::function<T> callback;
+
+			// Module which registered the command
+			HMODULE owner;
 		};
 
 		using ChatCommand = Command<void(AShooterPlayerController*, FString*, EChatSendMode::Type)>;
@@ -112,6 +127,11 @@ namespace ArkApi
 			{
 				if (command_text.Compare(command->command, ESearchCase::IgnoreCase) == 0)
 				{
+					// Arguments may contain passwords
+					API::FlightRecorder::Get().Record(API::FlightRecorder::Category::Command,
+					                                  std::wstring_view(*command_text, command_text.Len()));
+
+					API::PluginStats::ScopedTimer timer(command->owner);
 					command->callback(std::forward<Args>(args)...);
 
 					return true;
@@ -6,6 +6,8 @@
 
 #include "Offsets.h"
 #include "IBaseApi.h"
+#include "PluginManager/PluginStats.h"
+#include <FlightRecorder.h>
 #include <detours.h>
 
 namespace API
@@ -24,6 +26,12 @@ namespace API
 			return false;
 		}
 
+		if (batching_)
+		{
+			pending_attach_.push_back({func_name, detour, original});
+			return true;
+		}
+
 		auto& hook_vector = all_hooks_[func_name];
 
 		LPVOID new_target = hook_vector.empty()
@@ -60,6 +68,8 @@ namespace API
 
 		hook_vector.push_back(std::make_shared<Hook>(new_target, detour, original));
 
+		FlightRecorder::Get().Record(FlightRecorder::Category::Hook, "Attached " + func_name);
+
 		return true;
 	}
 
@@ -72,6 +82,21 @@ namespace API
 			return false;
 		}
 
+		if (batching_)
+		{
+			// Hook was never attached
+			const auto pending_iter = std::find_if(pending_attach_.begin(), pending_attach_.end(),
+			                                       [&func_name, detour](const PendingHook& hook) -> bool
+			                                       {
+				                                       return hook.func_name == func_name && hook.detour == detour;
+			                                       });
+			if (pending_iter != pending_attach_.end())
+			{
+				pending_attach_.erase(pending_iter);
+				return true;
+			}
+		}
+
 		auto& hook_vector = all_hooks_[func_name];
 
 		const auto iter = std::find_if(hook_vector.begin(), hook_vector.end(),
@@ -86,6 +111,12 @@ namespace API
 			return false;
 		}
 
+		if (batching_)
+		{
+			pending_detach_[func_name].push_back(detour);
+			return true;
+		}
+
 		if (DetourTransactionBegin())
 		{
 			Log::GetLog()->error("Failed to create Detour Transaction for {}", func_name);
@@ -120,6 +151,8 @@ namespace API
 		// Remove hook from all_hooks vector
 		hook_vector.erase(std::remove(hook_vector.begin(), hook_vector.end(), *iter), hook_vector.end());
 
+		FlightRecorder::Get().Record(FlightRecorder::Category::Hook, "Detached " + func_name);
+
 		auto hook_vec(move(hook_vector));
 		hook_vector.clear();
 
@@ -131,6 +164,221 @@ namespace API
 
 		return true;
 	}
+
+	void Hooks::DisableModuleHooks(HMODULE module)
+	{
+		// DisableHook changes all_hooks_ outside of a batch
+		std::vector<std::pair<std::string, LPVOID>> module_hooks;
+		for (const auto& [func_name, hook_vector] : all_hooks_)
+		{
+			for (const auto& hook : hook_vector)
+			{
+				if (PluginStats::GetModule(hook->detour) == module)
+				{
+					module_hooks.emplace_back(func_name, hook->detour);
+				}
+			}
+		}
+
+		for (const auto& [func_name, detour] : module_hooks)
+		{
+			DisableHook(func_name, detour);
+		}
+	}
+
+	void Hooks::CountHooks(std::unordered_map<HMODULE, size_t>& counts) const
+	{
+		for (const auto& [func_name, hook_vector] : all_hooks_)
+		{
+			for (const auto& hook : hook_vector)
+			{
+				++counts[PluginStats::GetModule(hook->detour)];
+			}
+		}
+	}
+
+	void Hooks::BeginBatch()
+	{
+		batching_ = true;
+	}
+
+	bool Hooks::CommitBatch()
+	{
+		batching_ = false;
+
+		std::vector<PendingHook> pending;
+
+		if (!pending_detach_.empty())
+		{
+			// Hooks stay attached and registered if the detach fails, so their modules must not be freed.
+			// Hooks set during the batch are still attached so none of them is left behind for the next batch
+			const auto abort_detach = [this](const std::string& error)
+			{
+				Log::GetLog()->error(error);
+				DetourTransactionAbort();
+				pending_detach_.clear();
+
+				std::vector<PendingHook> pending_attach = std::move(pending_attach_);
+				pending_attach_.clear();
+				AttachPendingHooks(std::move(pending_attach));
+
+				return false;
+			};
+
+			if (DetourTransactionBegin())
+			{
+				return abort_detach("Failed to create Detour Transaction for batch");
+			}
+			if (DetourUpdateThread(GetCurrentThread()))
+			{
+				return abort_detach("Failed to update thread for batch");
+			}
+
+			// Remove all hooks placed on the affected functions
+			for (const auto& [func_name, detours] : pending_detach_)
+			{
+				for (const auto& hook : all_hooks_[func_name])
+				{
+					if (DetourDetach(&hook->target, hook->detour))
+					{
+						return abort_detach("Failed to detach Detour Transaction for " + func_name);
+					}
+				}
+			}
+
+			if (DetourTransactionCommit())
+			{
+				return abort_detach("Failed to commit Detour Transaction for batch");
+			}
+
+			// Hooks which were not removed are attached again in their original order
+			for (const auto& [func_name, detours] : pending_detach_)
+			{
+				auto& hook_vector = all_hooks_[func_name];
+
+				for (const auto& hook : hook_vector)
+				{
+					if (std::find(detours.begin(), detours.end(), hook->detour) == detours.end())
+					{
+						pending.push_back({func_name, hook->detour, hook->original});
+					}
+				}
+
+				hook_vector.clear();
+			}
+
+			pending_detach_.clear();
+		}
+
+		pending.insert(pending.end(), pending_attach_.begin(), pending_attach_.end());
+		pending_attach_.clear();
+
+		return AttachPendingHooks(std::move(pending));
+	}
+
+	bool Hooks::AttachPendingHooks(std::vector<PendingHook> pending)
+	{
+		// Each layer attaches at most one hook per function, hooks on the same function chain on the previous detour.
+		// Hooks of a failed layer and all later ones are attached one by one instead, they must never be dropped:
+		// re-attached hooks were detached already and their originals point to freed trampolines
+		const auto attach_one_by_one = [this](std::vector<PendingHook> remaining)
+		{
+			std::vector<std::string> failed;
+
+			for (const auto& hook : remaining)
+			{
+				if (!SetHookInternal(hook.func_name, hook.detour, hook.original))
+				{
+					// Calls through the original enter the function instead of a freed trampoline
+					*hook.original = Offsets::Get().GetAddress(hook.func_name);
+					failed.push_back(hook.func_name);
+				}
+			}
+
+			for (const auto& func_name : failed)
+			{
+				Log::GetLog()->error("Hook for {} could not be attached again", func_name);
+			}
+
+			return failed.empty();
+		};
+
+		while (!pending.empty())
+		{
+			std::vector<PendingHook> next_layer;
+			std::vector<std::pair<PendingHook, std::shared_ptr<Hook>>> layer;
+			std::unordered_map<std::string, bool> in_layer;
+
+			for (auto& hook : pending)
+			{
+				if (in_layer[hook.func_name])
+				{
+					next_layer.push_back(std::move(hook));
+					continue;
+				}
+
+				in_layer[hook.func_name] = true;
+
+				const auto& hook_vector = all_hooks_[hook.func_name];
+				const LPVOID target = hook_vector.empty()
+					                      ? Offsets::Get().GetAddress(hook.func_name)
+					                      : hook_vector.back()->detour;
+
+				layer.emplace_back(hook, std::make_shared<Hook>(target, hook.detour, hook.original));
+			}
+
+			// Hooks of the layer come first, so hooks on each function keep their order
+			const auto abort_layer = [&](const std::string& error)
+			{
+				Log::GetLog()->error(error);
+				DetourTransactionAbort();
+
+				std::vector<PendingHook> remaining;
+				remaining.reserve(layer.size() + next_layer.size());
+				for (auto& [hook, new_hook] : layer)
+				{
+					remaining.push_back(std::move(hook));
+				}
+				remaining.insert(remaining.end(), next_layer.begin(), next_layer.end());
+
+				attach_one_by_one(std::move(remaining));
+				return false;
+			};
+
+			if (DetourTransactionBegin())
+			{
+				return abort_layer("Failed to create Detour Transaction for batch");
+			}
+			if (DetourUpdateThread(GetCurrentThread()))
+			{
+				return abort_layer("Failed to update thread for batch");
+			}
+
+			for (auto& [hook, new_hook] : layer)
+			{
+				if (DetourAttach(&new_hook->target, new_hook->detour))
+				{
+					return abort_layer("Failed to attach hook for " + hook.func_name);
+				}
+			}
+
+			if (DetourTransactionCommit())
+			{
+				return abort_layer("Failed to commit Detour Transaction for batch");
+			}
+
+			for (auto& [hook, new_hook] : layer)
+			{
+				*new_hook->original = new_hook->target; //same as ppOriginal in MH_CreateHook
+
+				all_hooks_[hook.func_name].push_back(new_hook);
+			}
+
+			pending = std::move(next_layer);
+		}
+
+		return true;
+	}
 } // namespace API
 
 // Free function
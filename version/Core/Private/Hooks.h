@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace API
 {
@@ -23,7 +24,41 @@ namespace API
 
 		bool DisableHook(const std::string& func_name, LPVOID detour) override;
 
+		/**
+		 * \brief Defers hook changes until CommitBatch, so many plugins can be unloaded with few Detour transactions.
+		 * SetHook leaves *original unset until the commit, so only use it where no plugin code calls through
+		 * its original in between (e.g. around Plugin_Unload, never around Plugin_Init)
+		 */
+		void BeginBatch();
+
+		/**
+		 * \brief Applies deferred changes. All removed hooks are detached in one transaction,
+		 * remaining and new hooks are attached in one transaction per hook layer
+		 * \return true if all changes were applied. If the detach fails every hook stays attached.
+		 * If a layer fails to attach, its hooks and all later ones are attached one by one and failures are logged
+		 */
+		bool CommitBatch();
+
+		/**
+		 * \brief Disables all hooks whose detour is in the module, e.g. hooks a plugin didn't remove in Plugin_Unload
+		 */
+		void DisableModuleHooks(HMODULE module);
+
+		/**
+		 * \brief Counts active hooks by the module of their detour
+		 */
+		void CountHooks(std::unordered_map<HMODULE, size_t>& counts) const;
+
 	private:
+		struct PendingHook
+		{
+			std::string func_name;
+			LPVOID detour;
+			LPVOID* original;
+		};
+
+		bool AttachPendingHooks(std::vector<PendingHook> pending);
+
 		struct Hook
 		{
 			Hook(LPVOID target, LPVOID detour, LPVOID* original)
@@ -39,5 +74,9 @@ namespace API
 		};
 
 		std::unordered_map<std::string, std::vector<std::shared_ptr<Hook>>> all_hooks_;
+
+		bool batching_{false};
+		std::vector<PendingHook> pending_attach_;
+		std::unordered_map<std::string, std::vector<LPVOID>> pending_detach_;
 	};
 } // namespace API
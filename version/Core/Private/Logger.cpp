@@ -1,45 +1,123 @@
 #include <Logger/Logger.h>
 
-#include <fstream>
+#include <algorithm>
+#include <mutex>
 
+#include <Config.h>
 #include <Tools.h>
-#include <json.hpp>
+
+#include "AsyncLogSink.h"
 
 std::string GetLogName()
 {
-	static std::string log_name("-1");
-	if (log_name == "-1")
-	{
-		const std::string config_path = ArkApi::Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{config_path};
-		if (!file.is_open())
-		{
-			log_name = "";
-			return "";
-		}
-
-		nlohmann::json config;
-		file >> config;
-		file.close();
-
-		log_name = config["settings"].value("StaticLogPath", "");
-	}
+	static const std::string log_name = API::Config::Get().GetValue<std::string>(
+		API::Tools::GetCurrentDir() + "/config.json", "/settings/StaticLogPath", "");
 
 	return log_name;
 }
 
+std::shared_ptr<API::AsyncLogPipeline>& GetLogPipeline()
+{
+	static std::shared_ptr<API::AsyncLogPipeline> pipeline = []
+	{
+		const std::string config_path = API::Tools::GetCurrentDir() + "/config.json";
+		auto& config = API::Config::Get();
+
+		API::AsyncLogSettings settings;
+		settings.queue_size = config.GetValue<size_t>(config_path, "/settings/Logging/QueueSize",
+		                                              settings.queue_size);
+		settings.flush_interval_ms = config.GetValue<int>(config_path, "/settings/Logging/FlushIntervalMs",
+		                                                  settings.flush_interval_ms);
+
+		const std::string policy = config.GetValue<std::string>(config_path, "/settings/Logging/OverflowPolicy",
+		                                                        "Block");
+		if (policy == "Drop")
+			settings.overflow_policy = API::LogOverflowPolicy::Drop;
+		else if (policy == "DropOldest")
+			settings.overflow_policy = API::LogOverflowPolicy::DropOldest;
+
+		return std::make_shared<API::AsyncLogPipeline>(settings);
+	}();
+
+	return pipeline;
+}
+
 std::vector<spdlog::sink_ptr>& GetLogSinks()
 {
-	static std::vector<spdlog::sink_ptr> sinks{
-		std::make_shared<spdlog::sinks::wincolor_stdout_sink_mt>(),
-		std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-			!GetLogName().empty()
-				? GetLogName()
-				: spdlog::sinks::default_daily_file_name_calculator::
-				calc_filename(
-					API::Tools::GetCurrentDir() + "/logs/ArkApi_" + std::to_string(GetCurrentProcessId()) + ".log"),
-			1024 * 1024, 5)
-	};
+	static std::vector<spdlog::sink_ptr> sinks = []
+	{
+		auto& pipeline = GetLogPipeline();
+
+		std::vector<spdlog::sink_ptr> result{
+			pipeline->Wrap(std::make_shared<spdlog::sinks::wincolor_stdout_sink_mt>()),
+			pipeline->Wrap(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+				!GetLogName().empty()
+					? GetLogName()
+					: spdlog::sinks::default_daily_file_name_calculator::
+					calc_filename(
+						API::Tools::GetCurrentDir() + "/logs/ArkApi_" + std::to_string(GetCurrentProcessId()) + ".log"),
+				1024 * 1024, 5))
+		};
+
+		pipeline->Start();
+
+		return result;
+	}();
 
 	return sinks;
 }
+
+size_t GetLogDroppedCount()
+{
+	return GetLogPipeline()->GetDroppedCount();
+}
+
+bool FlushLogs(unsigned timeout_ms)
+{
+	return GetLogPipeline()->Flush(std::chrono::milliseconds(timeout_ms));
+}
+
+namespace
+{
+	struct LogRateLimits
+	{
+		std::mutex mutex;
+		std::vector<LogRateLimit*> sites;
+	};
+
+	// Never destroyed, sites of the API itself unregister during static destruction
+	LogRateLimits& GetLogRateLimits()
+	{
+		static auto* rate_limits = new LogRateLimits;
+		return *rate_limits;
+	}
+} // namespace
+
+void RegisterLogRateLimit(LogRateLimit* site)
+{
+	auto& rate_limits = GetLogRateLimits();
+
+	std::lock_guard<std::mutex> guard(rate_limits.mutex);
+	rate_limits.sites.push_back(site);
+}
+
+void UnregisterLogRateLimit(LogRateLimit* site)
+{
+	auto& rate_limits = GetLogRateLimits();
+
+	std::lock_guard<std::mutex> guard(rate_limits.mutex);
+	rate_limits.sites.erase(std::remove(rate_limits.sites.begin(), rate_limits.sites.end(), site),
+	                        rate_limits.sites.end());
+}
+
+void FlushLogRateLimits()
+{
+	auto& rate_limits = GetLogRateLimits();
+
+	// Sites of unloading plugins unregister under the same lock, so none is destroyed while it is flushed
+	std::lock_guard<std::mutex> guard(rate_limits.mutex);
+	for (LogRateLimit* site : rate_limits.sites)
+	{
+		site->Flush();
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <cwctype>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace API
+{
+	/**
+	 * \brief Online players indexed by every key plugins search by. Updated from the game hooks,
+	 * lookups don't touch game objects. Names are case-folded, character names are ordered for prefix search
+	 */
+	template <typename Controller>
+	class PlayerIndex
+	{
+	public:
+		struct Keys
+		{
+			uint64_t steam_id{0};
+			uint64_t player_id{0};
+			std::wstring steam_name;
+			std::wstring character_name;
+			int tribe_id{0};
+		};
+
+		static std::wstring Fold(std::wstring_view text)
+		{
+			std::wstring result(text);
+			for (auto& c : result)
+			{
+				c = static_cast<wchar_t>(std::towlower(c));
+			}
+
+			return result;
+		}
+
+		/**
+		 * \brief Adds the player or replaces all keys of an already indexed player
+		 */
+		void Set(Controller* controller, Keys keys)
+		{
+			Remove(controller);
+
+			if (keys.steam_id != 0)
+			{
+				steam_ids_[keys.steam_id] = controller;
+			}
+
+			if (keys.player_id != 0)
+			{
+				player_ids_[keys.player_id] = controller;
+			}
+
+			steam_names_.emplace(Fold(keys.steam_name), controller);
+			character_names_.emplace(Fold(keys.character_name), controller);
+			tribes_.emplace(keys.tribe_id, controller);
+
+			players_.emplace(controller, std::move(keys));
+		}
+
+		void Remove(Controller* controller)
+		{
+			const auto iter = players_.find(controller);
+			if (iter == players_.end())
+			{
+				return;
+			}
+
+			const Keys& keys = iter->second;
+
+			EraseUnique(steam_ids_, keys.steam_id, controller);
+			EraseUnique(player_ids_, keys.player_id, controller);
+			EraseMulti(steam_names_, Fold(keys.steam_name), controller);
+			EraseMulti(character_names_, Fold(keys.character_name), controller);
+			EraseMulti(tribes_, keys.tribe_id, controller);
+
+			players_.erase(iter);
+		}
+
+		const Keys* Find(Controller* controller) const
+		{
+			const auto iter = players_.find(controller);
+			return iter != players_.end() ? &iter->second : nullptr;
+		}
+
+		Controller* FindBySteamId(uint64_t steam_id) const
+		{
+			const auto iter = steam_ids_.find(steam_id);
+			return iter != steam_ids_.end() ? iter->second : nullptr;
+		}
+
+		Controller* FindByPlayerId(uint64_t player_id) const
+		{
+			const auto iter = player_ids_.find(player_id);
+			return iter != player_ids_.end() ? iter->second : nullptr;
+		}
+
+		Controller* FindBySteamName(std::wstring_view steam_name) const
+		{
+			const auto iter = steam_names_.find(Fold(steam_name));
+			return iter != steam_names_.end() ? iter->second : nullptr;
+		}
+
+		/**
+		 * \brief Calls func(controller, keys) for players whose case-folded character name equals
+		 * or, if full_match is false, starts with the case-folded name
+		 */
+		template <typename Func>
+		void ForEachByCharacterName(std::wstring_view character_name, bool full_match, Func&& func) const
+		{
+			const std::wstring folded = Fold(character_name);
+
+			for (auto iter = character_names_.lower_bound(folded); iter != character_names_.end(); ++iter)
+			{
+				const std::wstring& name = iter->first;
+				if (full_match ? name != folded : name.compare(0, folded.size(), folded) != 0)
+				{
+					break;
+				}
+
+				func(iter->second, players_.at(iter->second));
+			}
+		}
+
+		template <typename Func>
+		void ForEachByTribeId(int tribe_id, Func&& func) const
+		{
+			const auto range = tribes_.equal_range(tribe_id);
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				func(iter->second, players_.at(iter->second));
+			}
+		}
+
+		/**
+		 * \brief Calls func(controller, keys) for every indexed player
+		 */
+		template <typename Func>
+		void ForEach(Func&& func) const
+		{
+			for (const auto& [controller, keys] : players_)
+			{
+				func(controller, keys);
+			}
+		}
+
+	private:
+		template <typename Map, typename Key>
+		static void EraseUnique(Map& map, const Key& key, Controller* controller)
+		{
+			const auto iter = map.find(key);
+			if (iter != map.end() && iter->second == controller)
+			{
+				map.erase(iter);
+			}
+		}
+
+		template <typename Map, typename Key>
+		static void EraseMulti(Map& map, const Key& key, Controller* controller)
+		{
+			const auto range = map.equal_range(key);
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				if (iter->second == controller)
+				{
+					map.erase(iter);
+					return;
+				}
+			}
+		}
+
+		std::unordered_map<Controller*, Keys> players_;
+		std::unordered_map<uint64_t, Controller*> steam_ids_;
+		std::unordered_map<uint64_t, Controller*> player_ids_;
+		std::unordered_multimap<std::wstring, Controller*> steam_names_;
+		std::multimap<std::wstring, Controller*> character_names_;
+		std::unordered_multimap<int, Controller*> tribes_;
+	};
+} // namespace API
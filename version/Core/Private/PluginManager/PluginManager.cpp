@@ -1,13 +1,21 @@
 #include "PluginManager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
+#include <Config.h>
+#include <FlightRecorder.h>
 #include <Logger/Logger.h>
 #include <Tools.h>
 
 #include "../Helpers.h"
+#include "../Hooks.h"
 #include "../IBaseApi.h"
 
 namespace API
@@ -71,27 +79,19 @@ namespace API
 
 	nlohmann::json PluginManager::ReadSettingsConfig()
 	{
-		nlohmann::json config = nlohmann::json::object({});
-
-		const std::string config_path = Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{config_path};
-		if (!file.is_open())
-		{
-			return config;
-		}
-
-		file >> config;
-		file.close();
-
-		return config;
+		return *Config::Get().GetSnapshot(Tools::GetCurrentDir() + "/config.json");
 	}
 
 	void PluginManager::LoadAllPlugins()
 	{
 		namespace fs = std::filesystem;
 
+		const auto start_time = std::chrono::steady_clock::now();
+
 		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins";
 
+		std::vector<PendingPlugin> plugins;
+
 		for (const auto& dir_name : fs::directory_iterator(dir_path))
 		{
 			const auto& path = dir_name.path();
@@ -107,33 +107,106 @@ namespace API
 			const std::string full_dll_path = dir_file_path + "/" + filename + ".dll";
 			const std::string new_full_dll_path = dir_file_path + "/" + filename + ".dll.ArkApi";
 
-			try
+			// A reload was interrupted, the staged file is newer than the dll
+			const std::string staged_dll_path = dir_file_path + "/" + filename + ".dll.staged";
+			if (fs::exists(staged_dll_path))
 			{
-				// Loads the new .dll.ArkApi if it exists on startup as well
-				if (fs::exists(new_full_dll_path))
-				{
-					try {
-						copy_file(new_full_dll_path, full_dll_path, fs::copy_options::overwrite_existing);
-						fs::remove(new_full_dll_path);
-					}
-					catch (const std::exception& error) {
-						Log::GetLog()->warn("{}\n({}) Race condition hit! Waiting for other to finish", error.what(), __FUNCTION__);
-						while (fs::exists(new_full_dll_path))Sleep(1000);
-					}
+				std::error_code error;
+				fs::rename(staged_dll_path, full_dll_path, error);
+			}
+
+			// Loads the new .dll.ArkApi if it exists on startup as well
+			if (fs::exists(new_full_dll_path))
+			{
+				try {
+					copy_file(new_full_dll_path, full_dll_path, fs::copy_options::overwrite_existing);
+					fs::remove(new_full_dll_path);
 				}
+				catch (const std::exception& error) {
+					Log::GetLog()->warn("{}\n({}) Race condition hit! Waiting for other to finish", error.what(), __FUNCTION__);
+					while (fs::exists(new_full_dll_path))Sleep(1000);
+				}
+			}
+
+			if (!fs::exists(full_dll_path))
+			{
+				Log::GetLog()->warn("({}) Plugin {} does not exist", __FUNCTION__, filename);
+				continue;
+			}
+
+			if (IsPluginLoaded(filename))
+			{
+				Log::GetLog()->warn("({}) Plugin {} was already loaded", __FUNCTION__, filename);
+				continue;
+			}
 
-				std::stringstream stream;
+			PendingPlugin& plugin = plugins.emplace_back();
+			plugin.name = filename;
+		}
 
-				std::shared_ptr<Plugin>& plugin = LoadPlugin(filename);
+		// Plugin infos are needed for the dependency graph
+		std::vector<PendingPlugin*> all_plugins;
+		for (auto& plugin : plugins)
+		{
+			all_plugins.push_back(&plugin);
+		}
 
-				stream << "Loaded plugin " << (plugin->full_name.empty() ? plugin->name : plugin->full_name) << " V" <<
-					plugin->version << " (" << plugin->description << ")";
+		ParallelForEach(all_plugins, [](PendingPlugin& plugin)
+		{
+			const auto prepare_start = std::chrono::steady_clock::now();
 
-				Log::GetLog()->info(stream.str());
+			try
+			{
+				plugin.info = ReadPluginInfo(plugin.name);
+				CheckApiVersion(plugin.name, plugin.info);
+				PrefetchPluginLibrary(plugin.name);
 			}
 			catch (const std::exception& error)
 			{
-				Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+				plugin.error = error.what();
+			}
+
+			plugin.prepare_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now() - prepare_start).count();
+		});
+
+		// Dependencies are always loaded in an earlier level
+		const auto levels = SortByDependencies(plugins);
+
+		// DllMain, static initializers and Plugin_Init run on the main thread, each plugin is initialized before the next
+		// one is loaded
+		for (const auto& level : levels)
+		{
+			for (PendingPlugin* pending : level)
+			{
+				if (!pending->error.empty())
+				{
+					Log::GetLog()->warn("({}) {}", __FUNCTION__, pending->error);
+					continue;
+				}
+
+				try
+				{
+					const auto init_start = std::chrono::steady_clock::now();
+
+					const HINSTANCE h_module = LoadPluginLibrary(pending->name);
+					std::shared_ptr<Plugin>& plugin = InitPlugin(pending->name, h_module, pending->info);
+
+					const long long init_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+						std::chrono::steady_clock::now() - init_start).count();
+
+					std::stringstream stream;
+
+					stream << "Loaded plugin " << (plugin->full_name.empty() ? plugin->name : plugin->full_name) << " V" <<
+						plugin->version << " (" << plugin->description << ") in " << pending->prepare_ms + init_ms <<
+						" ms (load and init " << init_ms << " ms)";
+
+					Log::GetLog()->info(stream.str());
+				}
+				catch (const std::exception& error)
+				{
+					Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+				}
 			}
 		}
 
@@ -147,9 +220,16 @@ namespace API
 		{
 			reload_sleep_seconds_ = settings["settings"].value("AutomaticPluginReloadSeconds", 5);
 			save_world_before_reload_ = settings["settings"].value("SaveWorldBeforePluginReload", true);
+
+			if (!watcher_started_)
+			{
+				watcher_started_ = true;
+				std::thread(&PluginManager::WatchPluginChanges, this).detach();
+			}
 		}
 
-		Log::GetLog()->info("Loaded all plugins\n");
+		Log::GetLog()->info("Loaded all plugins in {} ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(
+			                    std::chrono::steady_clock::now() - start_time).count());
 	}
 
 	std::shared_ptr<Plugin>& PluginManager::LoadPlugin(const std::string& plugin_name) noexcept(false)
@@ -171,17 +251,34 @@ namespace API
 
 		auto plugin_info = ReadPluginInfo(plugin_name);
 
-		// Check version		
-		const auto required_version = static_cast<float>(plugin_info["MinApiVersion"]);
+		CheckApiVersion(plugin_name, plugin_info);
+
+		const HINSTANCE h_module = LoadPluginLibrary(plugin_name);
+
+		return InitPlugin(plugin_name, h_module, plugin_info);
+	}
+
+	void PluginManager::CheckApiVersion(const std::string& plugin_name, const nlohmann::json& plugin_info)
+	{
+		// Const operator[] on a missing key is undefined behavior
+		const auto required_version = plugin_info.value("MinApiVersion", .0f);
 		if (required_version != .0f && game_api->GetVersion() < required_version)
 		{
 			throw std::runtime_error("Plugin " + plugin_name + " requires newer API version!");
 		}
+	}
+
+	HINSTANCE PluginManager::LoadPluginLibrary(const std::string& plugin_name)
+	{
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+		const std::string full_dll_path = dir_path + "/" + plugin_name + ".dll";
 
+		// The file may still be locked by a copy, wait only if loading failed
 		HINSTANCE h_module = nullptr;
-		for (int retry = 1; retry <= 5, h_module == nullptr; retry++) {
+		for (int retry = 1; retry <= 5 && h_module == nullptr; retry++) {
 			h_module = LoadLibraryA(full_dll_path.c_str());
-			Sleep(100);
+			if (h_module == nullptr && retry < 5)
+				Sleep(100);
 		}
 		if (h_module == nullptr)
 		{
@@ -189,12 +286,32 @@ namespace API
 				"Failed to load plugin - " + plugin_name + "\nError code: " + std::to_string(GetLastError()));
 		}
 
+		return h_module;
+	}
+
+	void PluginManager::PrefetchPluginLibrary(const std::string& plugin_name)
+	{
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+		const std::string full_dll_path = dir_path + "/" + plugin_name + ".dll";
+
+		std::ifstream file{full_dll_path, std::ios::binary};
+
+		std::vector<char> buffer(1024 * 1024);
+		while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+		{
+		}
+	}
+
+	std::shared_ptr<Plugin>& PluginManager::InitPlugin(const std::string& plugin_name, HINSTANCE h_module,
+	                                                   nlohmann::json& plugin_info)
+	{
 		// Calls Plugin_Init (if found) after loading DLL
 		// Note: DllMain callbacks during LoadLibrary is load-locked so we cannot do things like WaitForMultipleObjects on threads
 		using pfnPluginInit = void(__fastcall*)();
 		const auto pfn_init = reinterpret_cast<pfnPluginInit>(GetProcAddress(h_module, "Plugin_Init"));
 		if (pfn_init != nullptr)
 		{
+			FlightRecorder::Get().Record(FlightRecorder::Category::Plugin, "Init " + plugin_name);
 			pfn_init();
 		}
 
@@ -204,7 +321,126 @@ namespace API
 		                                                             plugin_info["Dependencies"]));
 	}
 
-	void PluginManager::UnloadPlugin(const std::string& plugin_name) noexcept(false)
+	std::vector<std::vector<PluginManager::PendingPlugin*>> PluginManager::SortByDependencies(
+		std::vector<PendingPlugin>& plugins)
+	{
+		std::unordered_map<std::string, PendingPlugin*> by_name;
+		for (auto& plugin : plugins)
+		{
+			by_name[plugin.name] = &plugin;
+		}
+
+		// Only dependencies which are loaded in this batch affect the order
+		std::unordered_map<PendingPlugin*, size_t> unresolved;
+		std::unordered_map<std::string, std::vector<PendingPlugin*>> dependents;
+
+		for (auto& plugin : plugins)
+		{
+			size_t& count = unresolved[&plugin];
+
+			if (!plugin.info.contains("Dependencies"))
+			{
+				continue;
+			}
+
+			for (const std::string& dependency : plugin.info["Dependencies"])
+			{
+				if (by_name.find(dependency) != by_name.end() && dependency != plugin.name)
+				{
+					++count;
+					dependents[dependency].push_back(&plugin);
+				}
+			}
+		}
+
+		std::vector<std::vector<PendingPlugin*>> levels;
+
+		std::vector<PendingPlugin*> current;
+		for (auto& plugin : plugins)
+		{
+			if (unresolved[&plugin] == 0)
+			{
+				current.push_back(&plugin);
+			}
+		}
+
+		size_t sorted = 0;
+
+		while (!current.empty())
+		{
+			std::vector<PendingPlugin*> next;
+
+			for (PendingPlugin* plugin : current)
+			{
+				for (PendingPlugin* dependent : dependents[plugin->name])
+				{
+					if (--unresolved[dependent] == 0)
+					{
+						next.push_back(dependent);
+					}
+				}
+			}
+
+			sorted += current.size();
+			levels.push_back(std::move(current));
+			current = std::move(next);
+		}
+
+		if (sorted != plugins.size())
+		{
+			// Plugins in a cycle are loaded last in directory order
+			std::vector<PendingPlugin*> cyclic;
+			for (auto& plugin : plugins)
+			{
+				if (unresolved[&plugin] != 0)
+				{
+					Log::GetLog()->error("Plugin {} has circular dependencies", plugin.name);
+					cyclic.push_back(&plugin);
+				}
+			}
+
+			for (PendingPlugin* plugin : cyclic)
+			{
+				levels.push_back({plugin});
+			}
+		}
+
+		return levels;
+	}
+
+	void PluginManager::ParallelForEach(const std::vector<PendingPlugin*>& plugins,
+	                                    const std::function<void(PendingPlugin&)>& function)
+	{
+		const size_t threads_count = (std::min)(plugins.size(),
+		                                        static_cast<size_t>((std::max)(
+			                                        std::thread::hardware_concurrency(), 1u)));
+
+		std::atomic<size_t> next_index{0};
+
+		const auto worker = [&]()
+		{
+			for (size_t i = next_index++; i < plugins.size(); i = next_index++)
+			{
+				function(*plugins[i]);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < threads_count; ++i)
+		{
+			threads.emplace_back(worker);
+		}
+
+		// Calling thread takes part in the work as well
+		worker();
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::vector<std::string> PluginManager::UnloadPlugin(const std::string& plugin_name) noexcept(false)
 	{
 		namespace fs = std::filesystem;
 
@@ -222,22 +458,157 @@ namespace API
 			throw std::runtime_error("Plugin " + plugin_name + " does not exist");
 		}
 
-		// Calls Plugin_Unload (if found) just before unloading DLL to let DLL gracefully clean up
-		// Note: DllMain callbacks during FreeLibrary is load-locked so we cannot do things like WaitForMultipleObjects on threads
-		using pfnPluginUnload = void(__fastcall*)();
-		const auto pfn_unload = reinterpret_cast<pfnPluginUnload>(GetProcAddress((*iter)->h_module, "Plugin_Unload"));
-		if (pfn_unload != nullptr)
+		const auto unload_order = GetUnloadOrder({plugin_name});
+
+		std::vector<std::string> dependents;
+		for (const auto& dependent : unload_order)
+		{
+			if (dependent != plugin_name)
+			{
+				Log::GetLog()->warn("({}) Unloading {} because it depends on {}", __FUNCTION__, dependent, plugin_name);
+				dependents.push_back(dependent);
+			}
+		}
+
+		UnloadPlugins(unload_order);
+
+		return dependents;
+	}
+
+	void PluginManager::ReloadPlugins(const std::vector<std::string>& plugin_names,
+	                                  const std::function<void()>& before_load) noexcept(false)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+
+		const auto unload_order = GetUnloadOrder(plugin_names);
+
+		UnloadPlugins(unload_order);
+
+		if (before_load)
+		{
+			before_load();
+		}
+
+		// Dependencies are loaded before their dependents. Loads aren't batched, plugins may call the original
+		// function of their hooks from Plugin_Init
+		for (auto iter = unload_order.rbegin(); iter != unload_order.rend(); ++iter)
+		{
+			try
+			{
+				LoadPlugin(*iter);
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			}
+		}
+
+		Log::GetLog()->info("Reloaded {} plugins in {} ms", unload_order.size(),
+		                    std::chrono::duration_cast<std::chrono::milliseconds>(
+			                    std::chrono::steady_clock::now() - start_time).count());
+	}
+
+	std::vector<std::string> PluginManager::GetUnloadOrder(const std::vector<std::string>& plugin_names)
+	{
+		std::vector<std::string> order;
+		std::vector<std::string> visiting;
+
+		// Depth-first over the reverse dependency graph, a plugin is added after all of its dependents
+		std::function<void(const std::string&)> visit = [&](const std::string& name)
+		{
+			if (std::find(order.begin(), order.end(), name) != order.end()
+				|| std::find(visiting.begin(), visiting.end(), name) != visiting.end())
+			{
+				return;
+			}
+
+			visiting.push_back(name);
+
+			for (const auto& plugin : loaded_plugins_)
+			{
+				if (std::find(plugin->dependencies.begin(), plugin->dependencies.end(), name) != plugin->dependencies.
+					end())
+				{
+					visit(plugin->name);
+				}
+			}
+
+			visiting.pop_back();
+			order.push_back(name);
+		};
+
+		for (const auto& name : plugin_names)
+		{
+			if (IsPluginLoaded(name))
+			{
+				visit(name);
+			}
+		}
+
+		return order;
+	}
+
+	void PluginManager::UnloadPlugins(const std::vector<std::string>& unload_order) noexcept(false)
+	{
+		auto& hooks = static_cast<Hooks&>(*game_api->GetHooks());
+
+		// All Plugin_Unload calls first, so hooks of every plugin are removed before any code is freed
+		hooks.BeginBatch();
+
+		for (const auto& plugin_name : unload_order)
+		{
+			const auto iter = FindPlugin(plugin_name);
+
+			// Calls Plugin_Unload (if found) just before unloading DLL to let DLL gracefully clean up
+			// Note: DllMain callbacks during FreeLibrary is load-locked so we cannot do things like WaitForMultipleObjects on threads
+			// A plugin whose hooks couldn't be removed by an earlier attempt was already torn down
+			if (!(*iter)->unloaded)
+			{
+				using pfnPluginUnload = void(__fastcall*)();
+				const auto pfn_unload = reinterpret_cast<pfnPluginUnload>(GetProcAddress((*iter)->h_module,
+					"Plugin_Unload"));
+				if (pfn_unload != nullptr)
+				{
+					FlightRecorder::Get().Record(FlightRecorder::Category::Plugin, "Unload " + plugin_name);
+					pfn_unload();
+				}
+
+				(*iter)->unloaded = true;
+			}
+
+			// Hooks the plugin didn't remove, or which an earlier attempt failed to remove
+			hooks.DisableModuleHooks((*iter)->h_module);
+		}
+
+		// Freeing a module whose detours are still attached crashes on the next call of the hooked function
+		if (!hooks.CommitBatch())
 		{
-			pfn_unload();
+			std::string names;
+			for (const auto& plugin_name : unload_order)
+			{
+				names += (names.empty() ? "" : ", ") + plugin_name;
+			}
+
+			Log::GetLog()->error("({}) Failed to remove hooks, plugins stay loaded but unusable until they are "
+			                     "unloaded again - {}", __FUNCTION__, names);
+
+			throw std::runtime_error("Failed to remove hooks of " + names);
 		}
 
 		using LdrUnloadDll_ = BOOL(*)(HMODULE);
 		static LdrUnloadDll_ LdrUnloadDll = (LdrUnloadDll_)GetProcAddress(GetModuleHandleA("ntdll"), "LdrUnloadDll");
-		const BOOL result = LdrUnloadDll((*iter)->h_module);
-		
-		Log::GetLog()->info("({}) Unloaded {} code: {}", __FUNCTION__, plugin_name, result);
 
-		loaded_plugins_.erase(remove(loaded_plugins_.begin(), loaded_plugins_.end(), *iter), loaded_plugins_.end());
+		for (const auto& plugin_name : unload_order)
+		{
+			const auto iter = FindPlugin(plugin_name);
+
+			const BOOL result = LdrUnloadDll((*iter)->h_module);
+
+			Log::GetLog()->info("({}) Unloaded {} code: {}", __FUNCTION__, plugin_name, result);
+			FlightRecorder::Get().Record(FlightRecorder::Category::Plugin, "Freed " + plugin_name);
+
+			loaded_plugins_.erase(remove(loaded_plugins_.begin(), loaded_plugins_.end(), *iter), loaded_plugins_.end());
+		}
 	}
 
 	nlohmann::json PluginManager::ReadPluginInfo(const std::string& plugin_name)
@@ -311,83 +682,390 @@ namespace API
 	{
 		auto& pluginManager = Get();
 
-		const time_t now = time(nullptr);
-		if (now < pluginManager.next_reload_check_
-			|| !pluginManager.enable_plugin_reload_)
+		if (!pluginManager.enable_plugin_reload_)
 		{
 			return;
 		}
 
-		pluginManager.next_reload_check_ = now + pluginManager.reload_sleep_seconds_;
-
-		pluginManager.DetectPluginChanges();
+		pluginManager.ReloadStagedPlugins();
 	}
 
-	void PluginManager::DetectPluginChanges()
+	void PluginManager::WatchPluginChanges()
 	{
 		namespace fs = std::filesystem;
 
-		// Prevents saving world multiple times if multiple plugins are queued to be reloaded
-		bool save_world = save_world_before_reload_;
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins";
 
-		for (const auto& dir_name : fs::directory_iterator(
-			     Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins"))
+		HANDLE dir_handle = CreateFileA(dir_path.c_str(), FILE_LIST_DIRECTORY,
+		                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		                                OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (dir_handle == INVALID_HANDLE_VALUE)
 		{
-			const auto& path = dir_name.path();
-			if (!is_directory(path))
+			Log::GetLog()->error("({}) Failed to watch {} - {}", __FUNCTION__, dir_path, GetLastError());
+			return;
+		}
+
+		OVERLAPPED overlapped{};
+		overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+		// DWORD aligned as required by ReadDirectoryChangesW
+		std::vector<DWORD> buffer(16 * 1024);
+
+		// Plugin name -> time of the last change, files are staged once they stop changing
+		std::unordered_map<std::string, std::chrono::steady_clock::time_point> changed;
+
+		const auto rescan = [&]()
+		{
+			try
 			{
-				continue;
+				for (const auto& dir_name : fs::directory_iterator(dir_path))
+				{
+					const auto filename = dir_name.path().filename().stem().generic_string();
+					if (fs::exists(dir_name.path() / (filename + ".dll.ArkApi")))
+					{
+						changed[filename] = std::chrono::steady_clock::now();
+					}
+				}
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
 			}
+		};
 
-			const auto filename = path.filename().stem().generic_string();
+		// Pick up files which were copied before the watcher started
+		rescan();
 
-			const std::string plugin_folder = path.generic_string() + "/";
+		const auto quiet_period = std::chrono::seconds(reload_sleep_seconds_);
 
-			const std::string plugin_file_path = plugin_folder + filename + ".dll";
-			const std::string new_plugin_file_path = plugin_folder + filename + ".dll.ArkApi";
+		for (;;)
+		{
+			ResetEvent(overlapped.hEvent);
 
-			if (fs::exists(new_plugin_file_path) && FindPlugin(filename) != loaded_plugins_.end())
+			if (!ReadDirectoryChangesW(dir_handle, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)),
+			                           TRUE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+			                           FILE_NOTIFY_CHANGE_SIZE, nullptr, &overlapped, nullptr))
 			{
-#ifndef ATLAS_GAME // not on ATLAS
-				// Save the world in case the unload/load procedure causes crash
-				if (save_world)
+				Log::GetLog()->error("({}) ReadDirectoryChangesW failed - {}", __FUNCTION__, GetLastError());
+				break;
+			}
+
+			for (;;)
+			{
+				const DWORD wait_result = WaitForSingleObject(overlapped.hEvent, changed.empty() ? INFINITE : 250);
+
+				if (wait_result == WAIT_OBJECT_0)
 				{
-					Log::GetLog()->info("Saving world before reloading plugins ...");
-					ArkApi::GetApiUtils().GetShooterGameMode()->SaveWorld(true);
-					Log::GetLog()->info("World saved.");
+					DWORD bytes = 0;
+					GetOverlappedResult(dir_handle, &overlapped, &bytes, FALSE);
+
+					if (bytes == 0)
+					{
+						// Buffer overflow, changes were lost
+						rescan();
+						break;
+					}
+
+					auto* info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(buffer.data());
+					for (;;)
+					{
+						const std::wstring file_name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+						const std::wstring suffix = L".dll.ArkApi";
+
+						if (file_name.size() > suffix.size()
+							&& file_name.compare(file_name.size() - suffix.size(), suffix.size(), suffix) == 0)
+						{
+							const std::string plugin_name = fs::path(file_name).parent_path().generic_string();
+							if (!plugin_name.empty())
+							{
+								changed[plugin_name] = std::chrono::steady_clock::now();
+							}
+						}
+
+						if (info->NextEntryOffset == 0)
+							break;
+
+						info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(
+							reinterpret_cast<BYTE*>(info) + info->NextEntryOffset);
+					}
 
-					save_world = false; // do not save again if multiple plugins are reloaded in this loop
+					break;
 				}
-#endif
-				try
+
+				if (wait_result != WAIT_TIMEOUT)
 				{
-					UnloadPlugin(filename);
+					Log::GetLog()->error("({}) Wait failed - {}", __FUNCTION__, GetLastError());
+					CloseHandle(overlapped.hEvent);
+					CloseHandle(dir_handle);
+					return;
+				}
 
-					Sleep(2000);
+				// Stage files which were not touched for a while
+				const auto now = std::chrono::steady_clock::now();
 
-					try {
-						copy_file(new_plugin_file_path, plugin_file_path, fs::copy_options::overwrite_existing);
-						fs::remove(new_plugin_file_path);
+				for (auto iter = changed.begin(); iter != changed.end();)
+				{
+					if (now - iter->second >= quiet_period && StagePlugin(iter->first))
+					{
+						iter = changed.erase(iter);
 					}
-					catch (const std::exception& error) {
-						Log::GetLog()->warn("{}\n({}) Race condition hit! Waiting for other to finish", error.what(), __FUNCTION__);
-						while (fs::exists(new_plugin_file_path)) Sleep(1000);
+					else
+					{
+						++iter;
 					}
+				}
+			}
+		}
+
+		CloseHandle(overlapped.hEvent);
+		CloseHandle(dir_handle);
+	}
+
+	bool PluginManager::StagePlugin(const std::string& plugin_name)
+	{
+		namespace fs = std::filesystem;
+
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+		const std::string new_dll_path = dir_path + "/" + plugin_name + ".dll.ArkApi";
+		const std::string staged_dll_path = dir_path + "/" + plugin_name + ".dll.staged";
+
+		if (!fs::exists(new_dll_path))
+		{
+			return true;
+		}
+
+		// Exclusive open fails while the file is still being written
+		HANDLE file = CreateFileA(new_dll_path.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING,
+		                          FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		char header[2]{};
+		DWORD read = 0;
+		const bool valid = ReadFile(file, header, sizeof(header), &read, nullptr)
+			&& read == sizeof(header) && header[0] == 'M' && header[1] == 'Z';
+
+		CloseHandle(file);
+
+		if (!valid)
+		{
+			Log::GetLog()->warn("({}) {} is not a valid dll", __FUNCTION__, new_dll_path);
+			return true;
+		}
+
+		try
+		{
+			copy_file(new_dll_path, staged_dll_path, fs::copy_options::overwrite_existing);
+			fs::remove(new_dll_path);
+		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			return false;
+		}
+
+		std::lock_guard<std::mutex> guard(staged_mutex_);
+
+		if (std::find(staged_plugins_.begin(), staged_plugins_.end(), plugin_name) == staged_plugins_.end())
+		{
+			staged_plugins_.push_back(plugin_name);
+		}
+
+		return true;
+	}
+
+	namespace
+	{
+		// The file mapping may be released shortly after unloading
+		bool RenameWithRetry(const std::string& from, const std::string& to, std::error_code& error)
+		{
+			for (int retry = 1; retry <= 20; retry++)
+			{
+				std::filesystem::rename(from, to, error);
+				if (!error)
+				{
+					return true;
+				}
+
+				Sleep(50);
+			}
 
-					// Wait 1 second before loading to let things clean up correctly...
-					// This will load the plugin in the next timer callback
-					//auto_reload_pending_plugins_.emplace_back(filename);
+			return false;
+		}
+	} // namespace
+
+	void PluginManager::ReplacePluginFile(const std::string& plugin_name)
+	{
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+		const std::string full_dll_path = dir_path + "/" + plugin_name + ".dll";
+		const std::string staged_dll_path = dir_path + "/" + plugin_name + ".dll.staged";
+		const std::string backup_dll_path = dir_path + "/" + plugin_name + ".dll.backup";
+
+		std::error_code error;
+		if (!RenameWithRetry(full_dll_path, backup_dll_path, error))
+		{
+			throw std::runtime_error("Failed to back up " + full_dll_path + " - " + error.message());
+		}
+
+		if (!RenameWithRetry(staged_dll_path, full_dll_path, error))
+		{
+			const std::string message = error.message();
+
+			RestorePluginFile(plugin_name);
+
+			throw std::runtime_error("Failed to replace " + full_dll_path + " - " + message);
+		}
+	}
+
+	bool PluginManager::RestorePluginFile(const std::string& plugin_name)
+	{
+		namespace fs = std::filesystem;
+
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+		const std::string full_dll_path = dir_path + "/" + plugin_name + ".dll";
+		const std::string backup_dll_path = dir_path + "/" + plugin_name + ".dll.backup";
+
+		if (!fs::exists(backup_dll_path))
+		{
+			return false;
+		}
+
+		std::error_code error;
+		if (!RenameWithRetry(backup_dll_path, full_dll_path, error))
+		{
+			Log::GetLog()->error("({}) Failed to restore {} - {}", __FUNCTION__, full_dll_path, error.message());
+			return false;
+		}
+
+		return true;
+	}
+
+	void PluginManager::RemovePluginBackup(const std::string& plugin_name)
+	{
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name;
+
+		std::error_code error;
+		std::filesystem::remove(dir_path + "/" + plugin_name + ".dll.backup", error);
+	}
+
+	void PluginManager::ReloadStagedPlugins()
+	{
+		std::vector<std::string> staged;
+
+		{
+			std::lock_guard<std::mutex> guard(staged_mutex_);
+			staged.swap(staged_plugins_);
+		}
 
-					LoadPlugin(filename);
+		if (staged.empty())
+		{
+			return;
+		}
 
-					Log::GetLog()->info("Reloaded plugin - {}", filename);
+		std::vector<std::string> loaded;
+		for (const auto& plugin_name : staged)
+		{
+			if (IsPluginLoaded(plugin_name))
+			{
+				loaded.push_back(plugin_name);
+			}
+			else
+			{
+				try
+				{
+					ReplacePluginFile(plugin_name);
+					RemovePluginBackup(plugin_name);
+					Log::GetLog()->info("Updated plugin file - {}", plugin_name);
 				}
 				catch (const std::exception& error)
 				{
 					Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
-					continue;
 				}
 			}
 		}
+
+		if (loaded.empty())
+		{
+			return;
+		}
+
+#ifndef ATLAS_GAME // not on ATLAS
+		// Save the world in case the unload/load procedure causes crash
+		if (save_world_before_reload_)
+		{
+			Log::GetLog()->info("Saving world before reloading plugins ...");
+			ArkApi::GetApiUtils().GetShooterGameMode()->SaveWorld(true);
+			Log::GetLog()->info("World saved.");
+		}
+#endif
+
+		const auto reload_order = GetUnloadOrder(loaded);
+
+		try
+		{
+			// Dependents of the changed plugins are reloaded as well, all in one step
+			ReloadPlugins(loaded, [&loaded]()
+			{
+				for (const auto& plugin_name : loaded)
+				{
+					try
+					{
+						ReplacePluginFile(plugin_name);
+					}
+					catch (const std::exception& error)
+					{
+						Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+					}
+				}
+			});
+		}
+		catch (const std::exception& error)
+		{
+			// Nothing was replaced if the plugins couldn't be unloaded
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			return;
+		}
+
+		// The previous version is loaded again if the new one failed to load
+		bool restored = false;
+		for (const auto& plugin_name : loaded)
+		{
+			if (IsPluginLoaded(plugin_name))
+			{
+				RemovePluginBackup(plugin_name);
+				Log::GetLog()->info("Reloaded plugin - {}", plugin_name);
+			}
+			else if (RestorePluginFile(plugin_name))
+			{
+				Log::GetLog()->warn("({}) Restoring previous version of {}", __FUNCTION__, plugin_name);
+				restored = true;
+			}
+		}
+
+		if (!restored)
+		{
+			return;
+		}
+
+		// Dependents which failed with the new version are retried as well
+		for (auto iter = reload_order.rbegin(); iter != reload_order.rend(); ++iter)
+		{
+			if (IsPluginLoaded(*iter))
+			{
+				continue;
+			}
+
+			try
+			{
+				LoadPlugin(*iter);
+				Log::GetLog()->info("Loaded plugin - {}", *iter);
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->error("({}) {}", __FUNCTION__, error.what());
+			}
+		}
 	}
 } // namespace API
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +33,10 @@ namespace API
 		float version;
 		float min_api_version;
 		std::vector<std::string> dependencies;
+
+		// Plugin_Unload was called but the module couldn't be freed, the plugin is unusable and Plugin_Unload
+		// must not be called again
+		bool unloaded{false};
 	};
 
 	class PluginManager
@@ -62,9 +68,20 @@ namespace API
 
 		/**
 		 * \brief Unload plugin by it's name. Plugin must free all used resources.
+		 * Loaded plugins which depend on it are unloaded first and are not loaded again.
 		 * \param plugin_name File name of the plugin
+		 * \return Names of the dependents which were unloaded as well
 		 */
-		void UnloadPlugin(const std::string& plugin_name) noexcept(false);
+		std::vector<std::string> UnloadPlugin(const std::string& plugin_name) noexcept(false);
+
+		/**
+		 * \brief Unloads the plugins together with all plugins that depend on them and loads them again in dependency order.
+		 * Hooks of all affected plugins are removed and installed in one batch
+		 * \param plugin_names File names of the plugins
+		 * \param before_load Called after all plugins were unloaded, e.g. to replace the dll files
+		 */
+		void ReloadPlugins(const std::vector<std::string>& plugin_names,
+		                   const std::function<void()>& before_load = nullptr) noexcept(false);
 
 		/**
 		 * \brief Find plugin by it's name
@@ -78,21 +95,93 @@ namespace API
 		*/
 		bool IsPluginLoaded(const std::string& plugin_name);
 
+		const std::vector<std::shared_ptr<Plugin>>& GetLoadedPlugins() const { return loaded_plugins_; }
+
 		/**
-		* \brief Checks for auto plugin reloads
+		* \brief Swaps plugins which were staged by the watcher thread
 		*/
 		static void DetectPluginChangesTimerCallback();
 	private:
 		PluginManager() = default;
 		~PluginManager() = default;
 
+		/**
+		 * \brief Plugin whose info was read off the main thread and waits to be loaded
+		 */
+		struct PendingPlugin
+		{
+			std::string name;
+			nlohmann::json info;
+			std::string error;
+
+			long long prepare_ms{0};
+		};
+
 		static nlohmann::json ReadPluginInfo(const std::string& plugin_name);
+		static void CheckApiVersion(const std::string& plugin_name, const nlohmann::json& plugin_info);
+		static HINSTANCE LoadPluginLibrary(const std::string& plugin_name);
+
+		/**
+		 * \brief Reads the DLL once so LoadLibrary on the main thread maps it from the file cache
+		 */
+		static void PrefetchPluginLibrary(const std::string& plugin_name);
+
+		std::shared_ptr<Plugin>& InitPlugin(const std::string& plugin_name, HINSTANCE h_module,
+		                                    nlohmann::json& plugin_info);
+
+		/**
+		 * \brief Sorts plugins into levels, plugins of a level only depend on plugins of previous levels
+		 */
+		static std::vector<std::vector<PendingPlugin*>> SortByDependencies(std::vector<PendingPlugin>& plugins);
+
+		/**
+		 * \brief Runs the function for every plugin on worker threads and waits for all of them
+		 */
+		static void ParallelForEach(const std::vector<PendingPlugin*>& plugins,
+		                            const std::function<void(PendingPlugin&)>& function);
 		static nlohmann::json ReadPluginPDBConfig(const std::string& plugin_name);
 		static nlohmann::json ReadSettingsConfig();
 
 		void CheckPluginsDependencies();
 
-		void DetectPluginChanges();
+		/**
+		 * \brief Returns the loaded plugins and everything that depends on them, dependents come first
+		 */
+		std::vector<std::string> GetUnloadOrder(const std::vector<std::string>& plugin_names);
+
+		/**
+		 * \brief Unloads the plugins in the given order with hook removal batched.
+		 * Throws and keeps every module loaded if the hooks couldn't be removed. Those plugins stay marked as unloaded,
+		 * unloading them again only retries the hook removal
+		 */
+		void UnloadPlugins(const std::vector<std::string>& unload_order) noexcept(false);
+
+		/**
+		 * \brief Watches the plugins directory for new .dll.ArkApi files, runs on a background thread
+		 */
+		void WatchPluginChanges();
+
+		/**
+		 * \brief Copies <plugin>.dll.ArkApi to <plugin>.dll.staged once the file is completely written
+		 * \return false if the file is still in use and staging has to be retried
+		 */
+		bool StagePlugin(const std::string& plugin_name);
+
+		/**
+		 * \brief Replaces <plugin>.dll by the staged file, the plugin must be unloaded.
+		 * The previous file is kept as <plugin>.dll.backup until RemovePluginBackup or RestorePluginFile
+		 */
+		static void ReplacePluginFile(const std::string& plugin_name);
+
+		/**
+		 * \brief Moves <plugin>.dll.backup back to <plugin>.dll, the plugin must be unloaded
+		 * \return false if there is no backup or it couldn't be moved
+		 */
+		static bool RestorePluginFile(const std::string& plugin_name);
+
+		static void RemovePluginBackup(const std::string& plugin_name);
+
+		void ReloadStagedPlugins();
 
 		std::vector<std::shared_ptr<Plugin>> loaded_plugins_;
 
@@ -100,6 +189,10 @@ namespace API
 		bool enable_plugin_reload_{false};
 		int reload_sleep_seconds_{5};
 		bool save_world_before_reload_{true};
-		time_t next_reload_check_{5};
+		bool watcher_started_{false};
+
+		// Plugins staged by the watcher thread which wait for the swap on the game thread
+		std::vector<std::string> staged_plugins_;
+		std::mutex staged_mutex_;
 	};
 } // namespace API
@@ -0,0 +1,215 @@
+#include "PluginStats.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include <Timer.h>
+
+#include "PluginManager.h"
+#include "../Commands.h"
+#include "../Hooks.h"
+#include "../IBaseApi.h"
+
+namespace API
+{
+	namespace
+	{
+		// Time of nested callbacks of the current callback
+		thread_local long long child_time_ns = 0;
+
+		thread_local HMODULE current_owner = nullptr;
+	} // namespace
+
+	PluginStats::ScopedTimer::ScopedTimer(HMODULE owner)
+		: owner_(owner),
+		  start_(std::chrono::steady_clock::now()),
+		  parent_child_ns_(child_time_ns)
+	{
+		child_time_ns = 0;
+	}
+
+	PluginStats::ScopedTimer::~ScopedTimer()
+	{
+		const long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start_).count();
+
+		Get().AddTime(owner_, elapsed - child_time_ns);
+
+		child_time_ns = parent_child_ns_ + elapsed;
+	}
+
+	PluginStats::CallerScope::CallerScope(void* return_address)
+		: outermost_(current_owner == nullptr)
+	{
+		if (outermost_)
+		{
+			current_owner = GetModule(return_address);
+		}
+	}
+
+	PluginStats::CallerScope::~CallerScope()
+	{
+		if (outermost_)
+		{
+			current_owner = nullptr;
+		}
+	}
+
+	PluginStats& PluginStats::Get()
+	{
+		static PluginStats instance;
+		return instance;
+	}
+
+	HMODULE PluginStats::GetModule(const void* address)
+	{
+		HMODULE module = nullptr;
+		GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+		                   static_cast<LPCSTR>(address), &module);
+
+		return module;
+	}
+
+	HMODULE PluginStats::GetCurrentOwner()
+	{
+		return current_owner;
+	}
+
+	void PluginStats::AddTrampolineBytes(HMODULE owner, size_t bytes)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		counters_[owner].trampoline_bytes += bytes;
+	}
+
+	void PluginStats::BeginRequest(HMODULE owner)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		Counters& counters = counters_[owner];
+		++counters.requests_in_flight;
+		++counters.requests_total;
+	}
+
+	void PluginStats::EndRequest(HMODULE owner)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		Counters& counters = counters_[owner];
+		if (counters.requests_in_flight > 0)
+		{
+			--counters.requests_in_flight;
+		}
+	}
+
+	void PluginStats::AddTime(HMODULE owner, long long time_ns)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		Counters& counters = counters_[owner];
+		counters.cpu_time_ns += time_ns;
+		++counters.calls;
+	}
+
+	std::unordered_map<HMODULE, PluginStats::Counters> PluginStats::Collect()
+	{
+		std::unordered_map<HMODULE, Counters> result;
+
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			result = counters_;
+		}
+
+		std::unordered_map<HMODULE, size_t> hooks;
+		static_cast<Hooks&>(*game_api->GetHooks()).CountHooks(hooks);
+
+		std::unordered_map<HMODULE, size_t> commands;
+		std::unordered_map<HMODULE, size_t> callbacks;
+		static_cast<ArkApi::Commands&>(*game_api->GetCommands()).CountCommands(commands, callbacks);
+
+		std::unordered_map<HMODULE, size_t> timer_tasks;
+		Timer::Get().CountTasks(timer_tasks);
+
+		for (const auto& [module, count] : hooks)
+			result[module].hooks = count;
+		for (const auto& [module, count] : commands)
+			result[module].commands = count;
+		for (const auto& [module, count] : callbacks)
+			result[module].callbacks = count;
+		for (const auto& [module, count] : timer_tasks)
+			result[module].timer_tasks = count;
+
+		return result;
+	}
+
+	nlohmann::json PluginStats::ToJson()
+	{
+		nlohmann::json result = nlohmann::json::object();
+
+		for (const auto& [module, counters] : Collect())
+		{
+			result[GetModuleName(module)] = {
+				{"CpuTimeMs", counters.cpu_time_ns / 1000000.0},
+				{"Calls", counters.calls},
+				{"Hooks", counters.hooks},
+				{"Commands", counters.commands},
+				{"Callbacks", counters.callbacks},
+				{"TimerTasks", counters.timer_tasks},
+				{"RequestsInFlight", counters.requests_in_flight},
+				{"RequestsTotal", counters.requests_total},
+				{"TrampolineBytes", counters.trampoline_bytes}
+			};
+		}
+
+		return result;
+	}
+
+	std::string PluginStats::ToString()
+	{
+		auto stats = Collect();
+
+		std::vector<std::pair<HMODULE, Counters>> sorted(stats.begin(), stats.end());
+		std::sort(sorted.begin(), sorted.end(), [](const auto& left, const auto& right)
+		{
+			return left.second.cpu_time_ns > right.second.cpu_time_ns;
+		});
+
+		std::stringstream stream;
+
+		for (const auto& [module, counters] : sorted)
+		{
+			stream << GetModuleName(module) << ": " << counters.cpu_time_ns / 1000000 << " ms in " << counters.calls
+				<< " calls, " << counters.hooks << " hooks, " << counters.commands << " commands, " << counters.callbacks
+				<< " callbacks, " << counters.timer_tasks << " timers, " << counters.requests_in_flight << "/"
+				<< counters.requests_total << " requests, " << counters.trampoline_bytes << " trampoline bytes\n";
+		}
+
+		return stream.str();
+	}
+
+	std::string PluginStats::GetModuleName(HMODULE module)
+	{
+		if (module == nullptr)
+		{
+			return "Unknown";
+		}
+
+		if (module == GetModule(reinterpret_cast<const void*>(&PluginStats::GetModule)))
+		{
+			return game_api->GetApiName();
+		}
+
+		for (const auto& plugin : PluginManager::Get().GetLoadedPlugins())
+		{
+			if (plugin->h_module == module)
+			{
+				return plugin->name;
+			}
+		}
+
+		char buffer[MAX_PATH]{};
+		GetModuleFileNameA(module, buffer, MAX_PATH);
+
+		return std::filesystem::path(buffer).stem().string();
+	}
+} // namespace API
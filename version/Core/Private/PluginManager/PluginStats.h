@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <windows.h>
+
+#include "json.hpp"
+
+namespace API
+{
+	/**
+	 * \brief Per-plugin cost accounting. A plugin is identified by the module which contains the code
+	 * of a registration (detour, callback caller, API caller)
+	 */
+	class PluginStats
+	{
+	public:
+		struct Counters
+		{
+			// Active registrations, counted when stats are collected
+			size_t hooks{0};
+			size_t commands{0};
+			size_t callbacks{0};
+			size_t timer_tasks{0};
+
+			size_t requests_in_flight{0};
+			size_t requests_total{0};
+
+			// Trampoline::allocate is the only allocator the API hands out. Game memory (FMemory) and the plugin's own
+			// heap are allocated directly by plugin code and aren't seen by the API
+			size_t trampoline_bytes{0};
+
+			// Game thread time spent in callbacks of the plugin, nested callbacks of other plugins are excluded
+			long long cpu_time_ns{0};
+			size_t calls{0};
+		};
+
+		/**
+		 * \brief Measures self time of a callback
+		 */
+		class ScopedTimer
+		{
+		public:
+			explicit ScopedTimer(HMODULE owner);
+			~ScopedTimer();
+
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		private:
+			HMODULE owner_;
+			std::chrono::steady_clock::time_point start_;
+			long long parent_child_ns_;
+		};
+
+		/**
+		 * \brief Remembers the caller of the outermost API function, nested API calls keep the plugin as owner
+		 */
+		class CallerScope
+		{
+		public:
+			explicit CallerScope(void* return_address);
+			~CallerScope();
+
+			CallerScope(const CallerScope&) = delete;
+			CallerScope& operator=(const CallerScope&) = delete;
+
+		private:
+			bool outermost_;
+		};
+
+		static PluginStats& Get();
+
+		PluginStats(const PluginStats&) = delete;
+		PluginStats(PluginStats&&) = delete;
+		PluginStats& operator=(const PluginStats&) = delete;
+		PluginStats& operator=(PluginStats&&) = delete;
+
+		/**
+		 * \brief Returns the module which contains the address
+		 */
+		static HMODULE GetModule(const void* address);
+
+		/**
+		 * \brief Returns the module of the current CallerScope, nullptr outside of API calls
+		 */
+		static HMODULE GetCurrentOwner();
+
+		/**
+		 * \brief Wraps the callback so its execution time is accounted to the owner
+		 */
+		template <typename R, typename... Args>
+		static std::function<R(Args...)> Track(HMODULE owner, std::function<R(Args...)> callback)
+		{
+			return [owner, callback = std::move(callback)](Args... args) -> R
+			{
+				ScopedTimer timer(owner);
+				return callback(std::forward<Args>(args)...);
+			};
+		}
+
+		void AddTrampolineBytes(HMODULE owner, size_t bytes);
+		void BeginRequest(HMODULE owner);
+		void EndRequest(HMODULE owner);
+
+		/**
+		 * \brief Merges active registrations with the accumulated counters
+		 */
+		std::unordered_map<HMODULE, Counters> Collect();
+
+		nlohmann::json ToJson();
+		std::string ToString();
+
+	private:
+		PluginStats() = default;
+		~PluginStats() = default;
+
+		static std::string GetModuleName(HMODULE module);
+
+		void AddTime(HMODULE owner, long long time_ns);
+
+		std::unordered_map<HMODULE, Counters> counters_;
+		std::mutex mutex_;
+	};
+} // namespace API
@@ -0,0 +1,412 @@
+#include <ActorRegistry.h>
+
+#include <Config.h>
+#include <IApiUtils.h>
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	// Entries of each family checked for team changes per tick
+	constexpr size_t refresh_per_tick = 4096;
+
+	namespace
+	{
+		const std::vector<AActor*> empty_actors;
+
+		int GetTeam(AActor* actor)
+		{
+			static const DWORD64 team_offset = GetAddress(nullptr, "AActor.TargetingTeam");
+			return Detail::ReadField<int>(actor, team_offset);
+		}
+	} // namespace
+
+	ActorRegistry::~ActorRegistry()
+	{
+		if (tick_registered_ && game_api)
+		{
+			game_api->GetCommands()->RemoveOnTickCallback("ActorRegistryUpdate");
+		}
+	}
+
+	ActorRegistry& ActorRegistry::Get()
+	{
+		static ActorRegistry instance;
+		return instance;
+	}
+
+	bool ActorRegistry::Track(UClass* the_class)
+	{
+		if (the_class == nullptr || IsTracked(the_class))
+		{
+			return false;
+		}
+
+		const auto family_index = static_cast<uint32_t>(families_.size());
+		families_.push_back(Family{the_class});
+
+		ObjectFilter filter;
+		filter.the_class = the_class;
+		filter.cast_flags = ClassCastFlags::CASTCLASS_AActor;
+
+		ForEachObject(filter, [this, family_index](UObject* object)
+		{
+			Add(family_index, reinterpret_cast<AActor*>(object));
+		});
+
+		if (!tick_registered_)
+		{
+			tick_registered_ = true;
+			game_api->GetCommands()->AddOnTickCallback("ActorRegistryUpdate", std::bind(&ActorRegistry::Update, this));
+		}
+
+		return true;
+	}
+
+	bool ActorRegistry::Track(const std::string& class_name)
+	{
+		UClass* the_class = Globals::FindClass(class_name);
+		if (the_class == nullptr)
+		{
+			Log::GetLog()->warn("({}) Class {} wasn't found", __FUNCTION__, class_name);
+			return false;
+		}
+
+		return Track(the_class);
+	}
+
+	bool ActorRegistry::IsTracked(UClass* the_class) const
+	{
+		return FindFamily(the_class) != nullptr;
+	}
+
+	const std::vector<AActor*>& ActorRegistry::GetActors(UClass* the_class)
+	{
+		const int family_index = FindFamilyIndex(the_class);
+		if (family_index == -1)
+		{
+			return empty_actors;
+		}
+
+		RemoveStale(family_index, nullptr);
+
+		return families_[family_index].actors;
+	}
+
+	const std::vector<AActor*>& ActorRegistry::GetTeamActors(UClass* the_class, int team)
+	{
+		const int family_index = FindFamilyIndex(the_class);
+		if (family_index == -1)
+		{
+			return empty_actors;
+		}
+
+		RemoveStale(family_index, &team);
+
+		const Family& family = families_[family_index];
+
+		const auto iter = family.teams.find(team);
+		return iter != family.teams.end() ? iter->second : empty_actors;
+	}
+
+	size_t ActorRegistry::GetTeamCount(UClass* the_class, int team)
+	{
+		return GetTeamActors(the_class, team).size();
+	}
+
+	void ActorRegistry::GetTeams(UClass* the_class, std::vector<int>& out) const
+	{
+		const Family* family = FindFamily(the_class);
+		if (family == nullptr)
+		{
+			return;
+		}
+
+		for (const auto& [team, team_actors] : family->teams)
+		{
+			out.push_back(team);
+		}
+	}
+
+	void ActorRegistry::OnServerReady()
+	{
+		const auto class_names = Config::Get().GetValue<std::vector<std::string>>(
+			Tools::GetCurrentDir() + "/config.json", "/settings/ActorRegistry/Classes", {});
+		for (const auto& class_name : class_names)
+		{
+			Track(class_name);
+		}
+	}
+
+	void ActorRegistry::OnBeginPlay(AActor* actor)
+	{
+		for (uint32_t family_index = 0; family_index < families_.size(); ++family_index)
+		{
+			if (!IsInstanceOf(actor, families_[family_index].the_class))
+			{
+				continue;
+			}
+
+			// An actor freed without Destroyed may have left its entry at this address
+			if (const Location* location = FindLocation(actor, family_index))
+			{
+				if (IsLive(families_[family_index], location->slot))
+				{
+					continue;
+				}
+
+				Remove(family_index, location->slot);
+			}
+
+			Add(family_index, actor);
+		}
+	}
+
+	void ActorRegistry::OnDestroyed(AActor* actor)
+	{
+		if (locations_.empty())
+		{
+			return;
+		}
+
+		while (true)
+		{
+			const auto iter = locations_.find(actor);
+			if (iter == locations_.end())
+			{
+				break;
+			}
+
+			Remove(iter->second.family, iter->second.slot);
+		}
+	}
+
+	const ActorRegistry::Family* ActorRegistry::FindFamily(UClass* the_class) const
+	{
+		// Only a handful of classes are tracked
+		for (const auto& family : families_)
+		{
+			if (family.the_class == the_class)
+			{
+				return &family;
+			}
+		}
+
+		return nullptr;
+	}
+
+	int ActorRegistry::FindFamilyIndex(UClass* the_class) const
+	{
+		for (size_t family_index = 0; family_index < families_.size(); ++family_index)
+		{
+			if (families_[family_index].the_class == the_class)
+			{
+				return static_cast<int>(family_index);
+			}
+		}
+
+		return -1;
+	}
+
+	bool ActorRegistry::IsInstanceOf(AActor* actor, UClass* the_class) const
+	{
+		ObjectFilter filter;
+		filter.the_class = the_class;
+
+		return Detail::MatchesFilter(Detail::ObjectLayout::Get(), filter, reinterpret_cast<UObject*>(actor));
+	}
+
+	ActorRegistry::Location* ActorRegistry::FindLocation(AActor* actor, uint32_t family_index)
+	{
+		const auto range = locations_.equal_range(actor);
+		for (auto iter = range.first; iter != range.second; ++iter)
+		{
+			if (iter->second.family == family_index)
+			{
+				return &iter->second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void ActorRegistry::Add(uint32_t family_index, AActor* actor)
+	{
+		Family& family = families_[family_index];
+
+		const int team = GetTeam(actor);
+		auto& team_actors = family.teams[team];
+
+		const auto weak = GetWeakReference(reinterpret_cast<UObject*>(actor));
+
+		const auto slot = static_cast<uint32_t>(family.actors.size());
+		family.actors.push_back(actor);
+		family.entries.push_back(Entry{
+			team, static_cast<uint32_t>(team_actors.size()), weak.ObjectIndex, weak.ObjectSerialNumber
+		});
+		team_actors.push_back(actor);
+
+		locations_.emplace(actor, Location{family_index, slot});
+	}
+
+	void ActorRegistry::Remove(uint32_t family_index, uint32_t slot)
+	{
+		Family& family = families_[family_index];
+		AActor* actor = family.actors[slot];
+
+		// Swap with the last actor of the team
+		const Entry entry = family.entries[slot];
+		auto& team_actors = family.teams[entry.team];
+
+		AActor* last_team_actor = team_actors.back();
+		team_actors[entry.team_slot] = last_team_actor;
+		team_actors.pop_back();
+
+		if (last_team_actor != actor)
+		{
+			family.entries[FindLocation(last_team_actor, family_index)->slot].team_slot = entry.team_slot;
+		}
+
+		if (team_actors.empty())
+		{
+			family.teams.erase(entry.team);
+		}
+
+		// Swap with the last actor of the family
+		const auto last_slot = static_cast<uint32_t>(family.actors.size() - 1);
+		if (slot != last_slot)
+		{
+			AActor* last_actor = family.actors[last_slot];
+
+			family.actors[slot] = last_actor;
+			family.entries[slot] = family.entries[last_slot];
+			FindLocation(last_actor, family_index)->slot = slot;
+		}
+
+		family.actors.pop_back();
+		family.entries.pop_back();
+
+		const auto range = locations_.equal_range(actor);
+		for (auto iter = range.first; iter != range.second; ++iter)
+		{
+			if (iter->second.family == family_index)
+			{
+				locations_.erase(iter);
+				break;
+			}
+		}
+	}
+
+	void ActorRegistry::SetTeam(Family& family, uint32_t slot, int team)
+	{
+		AActor* actor = family.actors[slot];
+		const auto family_index = static_cast<uint32_t>(&family - families_.data());
+
+		Entry& entry = family.entries[slot];
+
+		auto& old_team_actors = family.teams[entry.team];
+
+		AActor* last_team_actor = old_team_actors.back();
+		old_team_actors[entry.team_slot] = last_team_actor;
+		old_team_actors.pop_back();
+
+		if (last_team_actor != actor)
+		{
+			family.entries[FindLocation(last_team_actor, family_index)->slot].team_slot = entry.team_slot;
+		}
+
+		if (old_team_actors.empty())
+		{
+			family.teams.erase(entry.team);
+		}
+
+		auto& team_actors = family.teams[team];
+
+		entry.team = team;
+		entry.team_slot = static_cast<uint32_t>(team_actors.size());
+		team_actors.push_back(actor);
+	}
+
+	bool ActorRegistry::IsLive(const Family& family, uint32_t slot) const
+	{
+		const Entry& entry = family.entries[slot];
+		return FWeakObjectPtr::Resolve(entry.object_index, entry.serial_number, false) ==
+			reinterpret_cast<UObject*>(family.actors[slot]);
+	}
+
+	void ActorRegistry::RemoveStale(uint32_t family_index, const int* team)
+	{
+		Family& family = families_[family_index];
+
+		// Removal moves the last actor into the slot, so walk backwards over actors which were already checked
+		if (team == nullptr)
+		{
+			for (auto slot = static_cast<uint32_t>(family.actors.size()); slot-- > 0;)
+			{
+				if (!IsLive(family, slot))
+				{
+					Remove(family_index, slot);
+				}
+			}
+
+			return;
+		}
+
+		const auto iter = family.teams.find(*team);
+		if (iter == family.teams.end())
+		{
+			return;
+		}
+
+		// Removing the last actor erases the team, which can only happen on the final iteration
+		auto& team_actors = iter->second;
+		for (auto team_slot = static_cast<uint32_t>(team_actors.size()); team_slot-- > 0;)
+		{
+			const uint32_t slot = FindLocation(team_actors[team_slot], family_index)->slot;
+			if (!IsLive(family, slot))
+			{
+				Remove(family_index, slot);
+			}
+		}
+	}
+
+	void ActorRegistry::Update()
+	{
+		for (uint32_t family_index = 0; family_index < families_.size(); ++family_index)
+		{
+			Family& family = families_[family_index];
+
+			// Small families are checked once per tick, not again from the start
+			const size_t to_check = (std::min)(refresh_per_tick, family.actors.size());
+
+			for (size_t checked = 0; checked < to_check && !family.actors.empty(); ++checked)
+			{
+				if (family.refresh_cursor >= family.actors.size())
+				{
+					family.refresh_cursor = 0;
+				}
+
+				const auto slot = static_cast<uint32_t>(family.refresh_cursor);
+				AActor* actor = family.actors[slot];
+
+				// Resolve before reading the actor, it may have been freed
+				if (!IsLive(family, slot))
+				{
+					// The last actor moved into this slot, check it next
+					Remove(family_index, slot);
+					continue;
+				}
+
+				const int team = GetTeam(actor);
+				if (team != family.entries[slot].team)
+				{
+					SetTeam(family, slot, team);
+				}
+
+				++family.refresh_cursor;
+			}
+		}
+	}
+} // namespace API
@@ -0,0 +1,206 @@
+#include <BlueprintCache.h>
+
+#include <cwctype>
+
+#include <Config.h>
+#include <IApiUtils.h>
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+namespace API
+{
+	BlueprintCache& BlueprintCache::Get()
+	{
+		static BlueprintCache instance;
+		return instance;
+	}
+
+	size_t BlueprintCache::Hash(std::wstring_view path)
+	{
+		// FNV-1a over the case-folded path, so lookups don't need a folded copy
+		uint64_t hash = 14695981039346656037ULL;
+		for (const wchar_t c : path)
+		{
+			hash ^= static_cast<uint64_t>(std::towlower(c));
+			hash *= 1099511628211ULL;
+		}
+
+		return static_cast<size_t>(hash);
+	}
+
+	bool BlueprintCache::Equals(const std::wstring& folded, std::wstring_view path)
+	{
+		if (folded.size() != path.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < path.size(); ++i)
+		{
+			if (folded[i] != static_cast<wchar_t>(std::towlower(path[i])))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::wstring_view BlueprintCache::Trim(std::wstring_view path)
+	{
+		while (!path.empty() && std::iswspace(path.front()))
+		{
+			path.remove_prefix(1);
+		}
+
+		while (!path.empty() && std::iswspace(path.back()))
+		{
+			path.remove_suffix(1);
+		}
+
+		return path;
+	}
+
+	UObject* BlueprintCache::LoadObject(std::wstring_view blueprint)
+	{
+		const std::wstring_view path = Trim(blueprint);
+		if (path.empty())
+		{
+			return nullptr;
+		}
+
+		const size_t hash = Hash(path);
+
+		const auto range = objects_.equal_range(hash);
+		for (auto iter = range.first; iter != range.second; ++iter)
+		{
+			const ObjectEntry& entry = iter->second;
+			if (!Equals(entry.path, path))
+			{
+				continue;
+			}
+
+			if (UObject* object = FWeakObjectPtr::Resolve(entry.object_index, entry.serial_number, true))
+			{
+				return object;
+			}
+
+			// Collected by GC, load it again
+			objects_.erase(iter);
+			break;
+		}
+
+		const std::wstring name(path);
+
+		UObject* object = Globals::StaticLoadObject(UObject::StaticClass(), nullptr, name.c_str(), nullptr, 0, 0,
+		                                            true);
+		if (!object)
+		{
+			return nullptr;
+		}
+
+		const auto weak = GetWeakReference(object);
+
+		std::wstring folded(path);
+		for (auto& c : folded)
+		{
+			c = static_cast<wchar_t>(std::towlower(c));
+		}
+
+		objects_.emplace(hash, ObjectEntry{std::move(folded), weak.ObjectIndex, weak.ObjectSerialNumber});
+
+		return object;
+	}
+
+	UObject* BlueprintCache::LoadObject(const FString& blueprint)
+	{
+		return LoadObject(std::wstring_view(*blueprint, static_cast<size_t>(blueprint.Len())));
+	}
+
+	UObject* BlueprintCache::LoadObject(const wchar_t* blueprint)
+	{
+		return blueprint != nullptr ? LoadObject(std::wstring_view(blueprint)) : nullptr;
+	}
+
+	FString BlueprintCache::GetClassBlueprint(UClass* the_class, PathBuilder build_path)
+	{
+		if (the_class == nullptr)
+		{
+			return FString("");
+		}
+
+		const auto iter = paths_.find(the_class);
+		if (iter != paths_.end())
+		{
+			const PathEntry& entry = iter->second;
+
+			// The address could have been reused by another class after GC
+			if (FWeakObjectPtr::Resolve(entry.class_index, entry.serial_number, true) == the_class)
+			{
+				return FString(entry.path);
+			}
+
+			paths_.erase(iter);
+		}
+
+		FString path = build_path(the_class);
+		if (path.IsEmpty())
+		{
+			return path;
+		}
+
+		const auto weak = GetWeakReference(the_class);
+		paths_.emplace(the_class, PathEntry{std::wstring(*path, static_cast<size_t>(path.Len())), weak.ObjectIndex,
+		                                    weak.ObjectSerialNumber});
+
+		return path;
+	}
+
+	void BlueprintCache::Preload(const FString& blueprint)
+	{
+		if (server_ready_)
+		{
+			LoadObject(blueprint);
+		}
+		else
+		{
+			preload_queue_.emplace_back(*blueprint, static_cast<size_t>(blueprint.Len()));
+		}
+	}
+
+	void BlueprintCache::OnServerReady()
+	{
+		server_ready_ = true;
+
+		const auto blueprints = Config::Get().GetValue<std::vector<std::string>>(
+			Tools::GetCurrentDir() + "/config.json", "/settings/BlueprintCache/Preload", {});
+		for (const auto& blueprint : blueprints)
+		{
+			preload_queue_.emplace_back(Tools::Utf8Decode(blueprint));
+		}
+
+		size_t failed = 0;
+		for (const auto& blueprint : preload_queue_)
+		{
+			if (!LoadObject(blueprint))
+			{
+				Log::GetLog()->warn("({}) Failed to load {}", __FUNCTION__, Tools::Utf8Encode(blueprint));
+				++failed;
+			}
+		}
+
+		if (!preload_queue_.empty())
+		{
+			Log::GetLog()->info("Preloaded {} blueprints", preload_queue_.size() - failed);
+		}
+
+		preload_queue_.clear();
+		preload_queue_.shrink_to_fit();
+	}
+
+	void BlueprintCache::Clear()
+	{
+		objects_.clear();
+		paths_.clear();
+	}
+} // namespace API
@@ -0,0 +1,246 @@
+#include <Config.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	// How often the watcher thread compares write times of the loaded files
+	constexpr auto watch_interval = std::chrono::seconds(1);
+
+	Config::~Config()
+	{
+		if (tick_registered_ && game_api)
+		{
+			game_api->GetCommands()->RemoveOnTickCallback("ConfigUpdate");
+		}
+	}
+
+	Config& Config::Get()
+	{
+		static Config instance;
+		return instance;
+	}
+
+	Config::Snapshot Config::GetSnapshot(const std::string& path)
+	{
+		std::filesystem::path full_path;
+		const std::string key = GetKey(path, full_path);
+
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+
+			const auto iter = files_.find(key);
+			if (iter != files_.end())
+			{
+				return iter->second.snapshot;
+			}
+		}
+
+		// First use, the file is parsed without holding the lock
+		std::error_code error;
+		const auto write_time = std::filesystem::last_write_time(full_path, error);
+
+		Snapshot snapshot = Parse(full_path);
+		if (!snapshot)
+		{
+			snapshot = std::make_shared<const nlohmann::json>(nlohmann::json::object());
+		}
+
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		// Another thread might have loaded it in the meantime
+		const auto result = files_.try_emplace(key, File{full_path, snapshot, write_time});
+
+		return result.first->second.snapshot;
+	}
+
+	void Config::StartWatcher()
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		// Files loaded before the watcher started are picked up by its first pass
+		if (!watcher_started_)
+		{
+			watcher_started_ = true;
+			std::thread(&Config::WatchFiles, this).detach();
+		}
+	}
+
+	void Config::Subscribe(const std::string& id, const std::string& path, const Callback& callback)
+	{
+		std::filesystem::path full_path;
+		const std::string key = GetKey(path, full_path);
+
+		// Make sure the file is loaded and watched
+		GetSnapshot(path);
+
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		subscribers_[id] = Subscriber{key, callback};
+
+		if (!tick_registered_)
+		{
+			tick_registered_ = true;
+			game_api->GetCommands()->AddOnTickCallback("ConfigUpdate", std::bind(&Config::Update, this));
+		}
+	}
+
+	bool Config::Unsubscribe(const std::string& id)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		return subscribers_.erase(id) > 0;
+	}
+
+	std::string Config::GetKey(const std::string& path, std::filesystem::path& full_path)
+	{
+		full_path = std::filesystem::path(path);
+		if (full_path.is_relative())
+		{
+			full_path = std::filesystem::path(Tools::GetCurrentDir()) / full_path;
+		}
+
+		full_path = full_path.lexically_normal();
+
+		// Windows paths are case insensitive
+		std::string key = full_path.generic_string();
+		std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+
+		return key;
+	}
+
+	Config::Snapshot Config::Parse(const std::filesystem::path& path)
+	{
+		std::ifstream file{path};
+		if (!file.is_open())
+		{
+			return nullptr;
+		}
+
+		std::stringstream content;
+		content << file.rdbuf();
+
+		try
+		{
+			return std::make_shared<const nlohmann::json>(nlohmann::json::parse(content.str()));
+		}
+		catch (const std::exception& error)
+		{
+			// Logger reads its own settings from here, so it may not exist yet
+			if (Log::GetLog())
+			{
+				Log::GetLog()->error("({}) Failed to parse {} - {}", __FUNCTION__, path.generic_string(),
+				                     error.what());
+			}
+		}
+
+		return nullptr;
+	}
+
+	void Config::WatchFiles()
+	{
+		struct Candidate
+		{
+			std::string key;
+			std::filesystem::path path;
+			std::filesystem::file_time_type write_time;
+		};
+
+		std::vector<Candidate> candidates;
+
+		while (true)
+		{
+			std::this_thread::sleep_for(watch_interval);
+
+			candidates.clear();
+
+			{
+				std::lock_guard<std::mutex> guard(mutex_);
+
+				for (const auto& [key, file] : files_)
+				{
+					candidates.push_back({key, file.path, file.write_time});
+				}
+			}
+
+			for (const auto& candidate : candidates)
+			{
+				std::error_code error;
+				const auto write_time = std::filesystem::last_write_time(candidate.path, error);
+				if (error || write_time == candidate.write_time)
+				{
+					continue;
+				}
+
+				// Invalid file keeps the previous snapshot, the write time is still updated
+				// so the error is reported only once per save
+				Snapshot snapshot = Parse(candidate.path);
+
+				std::lock_guard<std::mutex> guard(mutex_);
+
+				auto& file = files_.at(candidate.key);
+				file.write_time = write_time;
+
+				if (snapshot)
+				{
+					file.snapshot = std::move(snapshot);
+
+					if (std::find(changed_files_.begin(), changed_files_.end(), candidate.key) == changed_files_.end())
+					{
+						changed_files_.push_back(candidate.key);
+					}
+				}
+			}
+		}
+	}
+
+	void Config::Update()
+	{
+		std::vector<std::pair<Callback, Snapshot>> notifications;
+
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+
+			if (changed_files_.empty())
+			{
+				return;
+			}
+
+			for (const auto& key : changed_files_)
+			{
+				const Snapshot& snapshot = files_.at(key).snapshot;
+
+				for (const auto& [id, subscriber] : subscribers_)
+				{
+					if (subscriber.key == key)
+					{
+						notifications.emplace_back(subscriber.callback, snapshot);
+					}
+				}
+			}
+
+			changed_files_.clear();
+		}
+
+		// Callbacks are free to subscribe or read other configs
+		for (const auto& [callback, snapshot] : notifications)
+		{
+			try
+			{
+				callback(snapshot);
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			}
+		}
+	}
+} // namespace API
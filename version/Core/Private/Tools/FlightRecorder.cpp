@@ -0,0 +1,260 @@
+#include <FlightRecorder.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+namespace API
+{
+	// Must be a power of two
+	constexpr uint64_t slot_count = 8192;
+
+	struct FlightRecorder::Slot
+	{
+		// 0 while the slot is being written, otherwise index of the event + 1
+		std::atomic<uint64_t> sequence{0};
+		int64_t time_ns{0};
+		uint32_t thread_id{0};
+		Category category{Category::Custom};
+		uint8_t length{0};
+		char text[106]{};
+	};
+
+	namespace
+	{
+		const char* category_names[] = {"Hook", "Command", "Request", "Plugin", "Custom"};
+
+		// Handled access violations can repeat quickly, dump them at most this often
+		constexpr ULONGLONG first_chance_interval_ms = 1000;
+
+		// Longest wait for the log writer, the last lines before a crash are the most useful ones
+		constexpr unsigned crash_log_flush_ms = 2000;
+		constexpr unsigned first_chance_log_flush_ms = 200;
+	} // namespace
+
+	FlightRecorder::FlightRecorder()
+		: slots_(std::make_unique<Slot[]>(slot_count))
+	{
+		static_assert(sizeof(Slot) == 128, "Slot should take two cache lines");
+	}
+
+	FlightRecorder& FlightRecorder::Get()
+	{
+		static FlightRecorder instance;
+		return instance;
+	}
+
+	template <typename CharT>
+	void FlightRecorder::RecordText(Category category, std::basic_string_view<CharT> text) noexcept
+	{
+		const uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = slots_[index & (slot_count - 1)];
+
+		// Readers must see the slot as unpublished before any of the payload changes
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		slot.thread_id = GetCurrentThreadId();
+		slot.category = category;
+
+		const size_t length = (std::min)(text.size(), sizeof(slot.text));
+		for (size_t i = 0; i < length; ++i)
+		{
+			const auto c = text[i];
+			slot.text[i] = c >= 0 && c < 0x80 ? static_cast<char>(c) : '?';
+		}
+
+		slot.length = static_cast<uint8_t>(length);
+
+		// Payload must be visible before the slot is published
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.sequence.store(index + 1, std::memory_order_relaxed);
+	}
+
+	void FlightRecorder::Record(Category category, std::string_view text) noexcept
+	{
+		RecordText(category, text);
+	}
+
+	void FlightRecorder::Record(Category category, std::wstring_view text) noexcept
+	{
+		RecordText(category, text);
+	}
+
+	std::string FlightRecorder::Dump(const std::string& reason)
+	{
+		const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+		tm tm{};
+		localtime_s(&tm, &now);
+
+		char time_str[32];
+		strftime(time_str, sizeof(time_str), "%Y%m%d-%H%M%S", &tm);
+
+		const std::string path = Tools::GetCurrentDir() + "/logs/FlightRecorder_" +
+			std::to_string(GetCurrentProcessId()) + "_" + time_str + ".log";
+
+		if (!WriteRing(path.c_str(), reason.c_str()))
+		{
+			Log::GetLog()->error("({}) Failed to write {}", __FUNCTION__, path);
+			return "";
+		}
+
+		return path;
+	}
+
+	void FlightRecorder::InstallCrashHandlers()
+	{
+		sprintf_s(crash_path_, "%s/logs/FlightRecorder_%lu_crash.log", Tools::GetCurrentDir().c_str(),
+		          GetCurrentProcessId());
+		sprintf_s(first_chance_path_, "%s/logs/FlightRecorder_%lu_firstchance.log", Tools::GetCurrentDir().c_str(),
+		          GetCurrentProcessId());
+
+		previous_filter_ = SetUnhandledExceptionFilter(&FlightRecorder::OnUnhandledException);
+
+		// The engine catches crashes itself, so the filter above is often never reached. The vectored handler sees
+		// exceptions before any __except block and can't tell whether they will be handled
+		AddVectoredExceptionHandler(0, &FlightRecorder::OnVectoredException);
+
+		std::set_terminate(&FlightRecorder::OnTerminate);
+	}
+
+	bool FlightRecorder::WriteRing(const char* path, const char* reason) const noexcept
+	{
+		const HANDLE file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+		                                FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		char line[256];
+		DWORD written;
+
+		int length = sprintf_s(line, "Flight recorder dump - %s\r\n", reason);
+		::WriteFile(file, line, static_cast<DWORD>(length), &written, nullptr);
+
+		const uint64_t next = next_.load(std::memory_order_acquire);
+		const uint64_t first = next > slot_count ? next - slot_count : 0;
+
+		for (uint64_t index = first; index < next; ++index)
+		{
+			const Slot& slot = slots_[index & (slot_count - 1)];
+
+			// Copy the slot and skip it if a writer touched it meanwhile
+			const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+			const int64_t time_ns = slot.time_ns;
+			const uint32_t thread_id = slot.thread_id;
+			const auto category = static_cast<size_t>(slot.category);
+			const uint8_t text_length = (std::min)(slot.length, static_cast<uint8_t>(sizeof(slot.text)));
+
+			char text[sizeof(slot.text) + 1];
+			memcpy(text, slot.text, text_length);
+			text[text_length] = '\0';
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence != index + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+			{
+				continue;
+			}
+
+			// Unix time in 100ns units since 1601
+			const ULONGLONG ticks = static_cast<ULONGLONG>(time_ns / 100) + 116444736000000000ULL;
+
+			FILETIME file_time{static_cast<DWORD>(ticks), static_cast<DWORD>(ticks >> 32)};
+			FILETIME local_time{};
+			SYSTEMTIME system_time{};
+			FileTimeToLocalFileTime(&file_time, &local_time);
+			FileTimeToSystemTime(&local_time, &system_time);
+
+			length = sprintf_s(line, "%02u:%02u:%02u.%03u [%lu][%s] %s\r\n", system_time.wHour, system_time.wMinute,
+			                   system_time.wSecond, system_time.wMilliseconds, thread_id,
+			                   category < std::size(category_names) ? category_names[category] : "?", text);
+			if (length > 0)
+			{
+				::WriteFile(file, line, static_cast<DWORD>(length), &written, nullptr);
+			}
+		}
+
+		CloseHandle(file);
+		return true;
+	}
+
+	LONG WINAPI FlightRecorder::OnUnhandledException(EXCEPTION_POINTERS* exception_info)
+	{
+		DumpCrash("unhandled exception");
+
+		const auto previous_filter = Get().previous_filter_;
+		return previous_filter ? previous_filter(exception_info) : EXCEPTION_CONTINUE_SEARCH;
+	}
+
+	LONG WINAPI FlightRecorder::OnVectoredException(EXCEPTION_POINTERS* exception_info)
+	{
+		switch (exception_info->ExceptionRecord->ExceptionCode)
+		{
+		case EXCEPTION_ACCESS_VIOLATION:
+		case EXCEPTION_STACK_OVERFLOW:
+		case EXCEPTION_ILLEGAL_INSTRUCTION:
+		case EXCEPTION_PRIV_INSTRUCTION:
+		case EXCEPTION_IN_PAGE_ERROR:
+		case EXCEPTION_INT_DIVIDE_BY_ZERO:
+			DumpFirstChance(*exception_info->ExceptionRecord);
+			break;
+		default:
+			break;
+		}
+
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+
+	void FlightRecorder::OnTerminate()
+	{
+		DumpCrash("std::terminate");
+		abort();
+	}
+
+	void FlightRecorder::DumpCrash(const char* reason) noexcept
+	{
+		FlightRecorder& recorder = Get();
+
+		// First fatal exception only, handlers run again while the engine reports the crash
+		if (recorder.crash_dumped_.exchange(true))
+		{
+			return;
+		}
+
+		recorder.WriteRing(recorder.crash_path_, reason);
+
+		FlushLogs(crash_log_flush_ms);
+	}
+
+	void FlightRecorder::DumpFirstChance(const EXCEPTION_RECORD& record) noexcept
+	{
+		FlightRecorder& recorder = Get();
+
+		// Every dump overwrites the previous one, so the file holds the exception closest to a crash
+		const ULONGLONG now = GetTickCount64();
+		ULONGLONG last = recorder.last_first_chance_ms_.load(std::memory_order_relaxed);
+		if ((last != 0 && now - last < first_chance_interval_ms) ||
+			!recorder.last_first_chance_ms_.compare_exchange_strong(last, now))
+		{
+			return;
+		}
+
+		char reason[96];
+		sprintf_s(reason, "first-chance exception 0x%08lX at %p", record.ExceptionCode, record.ExceptionAddress);
+
+		recorder.WriteRing(recorder.first_chance_path_, reason);
+
+		// The exception may not be handled, write out what was logged before it
+		FlushLogs(first_chance_log_flush_ms);
+	}
+} // namespace API
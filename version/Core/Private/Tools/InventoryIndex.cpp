@@ -0,0 +1,317 @@
+#include <InventoryIndex.h>
+
+#include <algorithm>
+
+#include <IApiUtils.h>
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	namespace
+	{
+		const std::vector<UPrimalItem*> empty_items;
+
+		// InventoryItemsField() returns a copy of the array, read it in place instead
+		const TArray<UPrimalItem*>& GetInventoryItems(UPrimalInventoryComponent* inventory)
+		{
+			static const DWORD64 items_offset = GetAddress(nullptr, "UPrimalInventoryComponent.InventoryItems");
+			return *reinterpret_cast<const TArray<UPrimalItem*>*>(reinterpret_cast<DWORD64>(inventory) + items_offset);
+		}
+
+		UClass* GetItemClass(UPrimalItem* item)
+		{
+			static const DWORD64 class_offset = GetAddress(nullptr, "UObjectBase.Class");
+			return *reinterpret_cast<UClass* const*>(reinterpret_cast<DWORD64>(item) + class_offset);
+		}
+	} // namespace
+
+	InventoryIndex::~InventoryIndex()
+	{
+		if (timer_registered_ && game_api)
+		{
+			game_api->GetCommands()->RemoveOnTimerCallback("InventoryIndexSweep");
+		}
+	}
+
+	InventoryIndex& InventoryIndex::Get()
+	{
+		static InventoryIndex instance;
+		return instance;
+	}
+
+	int InventoryIndex::GetItemCount(UPrimalInventoryComponent* inventory, UClass* item_class)
+	{
+		Index* index = GetIndex(inventory);
+		if (index == nullptr)
+		{
+			return 0;
+		}
+
+		const auto iter = index->classes.find(item_class);
+		return iter != index->classes.end() ? iter->second.quantity : 0;
+	}
+
+	const std::vector<UPrimalItem*>& InventoryIndex::GetItems(UPrimalInventoryComponent* inventory, UClass* item_class)
+	{
+		Index* index = GetIndex(inventory);
+		if (index == nullptr)
+		{
+			return empty_items;
+		}
+
+		auto iter = index->classes.find(item_class);
+		if (iter == index->classes.end())
+		{
+			return empty_items;
+		}
+
+		// Callers dereference the items, an item freed without a notification means the index is stale
+		if (!IsAlive(*index, iter->second))
+		{
+			index = Build(inventory);
+
+			iter = index->classes.find(item_class);
+			if (iter == index->classes.end())
+			{
+				return empty_items;
+			}
+		}
+
+		return iter->second.items;
+	}
+
+	void InventoryIndex::Invalidate(UPrimalInventoryComponent* inventory)
+	{
+		indices_.erase(inventory);
+	}
+
+	void InventoryIndex::OnItemAdded(UPrimalInventoryComponent* inventory, UPrimalItem* item)
+	{
+		Index* index = FindIndex(inventory);
+		if (index == nullptr)
+		{
+			return;
+		}
+
+		++index->generation;
+
+		if (item == nullptr || index->items.count(item) != 0)
+		{
+			return;
+		}
+
+		// Equipped items are added to EquippedItems
+		const auto& inventory_items = GetInventoryItems(inventory);
+		if (inventory_items.Find(item) != INDEX_NONE)
+		{
+			Add(*index, item);
+		}
+	}
+
+	void InventoryIndex::OnItemRemoved(UPrimalInventoryComponent* inventory, UPrimalItem* item)
+	{
+		if (Index* index = FindIndex(inventory))
+		{
+			++index->generation;
+			Remove(*index, item);
+		}
+	}
+
+	void InventoryIndex::OnItemQuantityUpdated(UPrimalInventoryComponent* inventory, UPrimalItem* item)
+	{
+		Index* index = FindIndex(inventory);
+		if (index == nullptr)
+		{
+			return;
+		}
+
+		++index->generation;
+
+		const auto iter = index->items.find(item);
+		if (iter == index->items.end())
+		{
+			return;
+		}
+
+		const int quantity = item->GetItemQuantity();
+
+		index->classes[iter->second.item_class].quantity += quantity - iter->second.quantity;
+		iter->second.quantity = quantity;
+	}
+
+	InventoryIndex::Index* InventoryIndex::FindIndex(UPrimalInventoryComponent* inventory)
+	{
+		if (indices_.empty())
+		{
+			return nullptr;
+		}
+
+		const auto iter = indices_.find(inventory);
+		if (iter == indices_.end())
+		{
+			return nullptr;
+		}
+
+		Index& index = iter->second;
+		if (FWeakObjectPtr::Resolve(index.object_index, index.serial_number, true) !=
+			reinterpret_cast<UObject*>(inventory))
+		{
+			indices_.erase(iter);
+			return nullptr;
+		}
+
+		return &index;
+	}
+
+	InventoryIndex::Index* InventoryIndex::GetIndex(UPrimalInventoryComponent* inventory)
+	{
+		if (inventory == nullptr)
+		{
+			return nullptr;
+		}
+
+		Index* index = FindIndex(inventory);
+		if (index == nullptr)
+		{
+			return Build(inventory);
+		}
+
+		const auto& inventory_items = GetInventoryItems(inventory);
+
+		// Notifications keep the index current, take the array as it is now
+		if (index->array_generation != index->generation)
+		{
+			index->array_generation = index->generation;
+			index->array_data = inventory_items.GetData();
+			index->array_num = inventory_items.Num();
+
+			return index;
+		}
+
+		// Items may have moved without a notification
+		if (index->array_data != inventory_items.GetData() || index->array_num != inventory_items.Num())
+		{
+			return Build(inventory);
+		}
+
+		return index;
+	}
+
+	InventoryIndex::Index* InventoryIndex::Build(UPrimalInventoryComponent* inventory)
+	{
+		if (!timer_registered_)
+		{
+			timer_registered_ = true;
+			game_api->GetCommands()->AddOnTimerCallback("InventoryIndexSweep", std::bind(&InventoryIndex::Sweep, this));
+		}
+
+		const auto weak = GetWeakReference(reinterpret_cast<UObject*>(inventory));
+		const auto& inventory_items = GetInventoryItems(inventory);
+
+		Index* index = &indices_[inventory];
+		*index = Index{weak.ObjectIndex, weak.ObjectSerialNumber};
+		index->array_data = inventory_items.GetData();
+		index->array_num = inventory_items.Num();
+
+		for (UPrimalItem* item : inventory_items)
+		{
+			if (item != nullptr)
+			{
+				Add(*index, item);
+			}
+		}
+
+		return index;
+	}
+
+	bool InventoryIndex::IsAlive(Index& index, ClassItems& class_items)
+	{
+		if (class_items.checked_generation == index.generation)
+		{
+			return true;
+		}
+
+		// A removed item can be freed and its address reused by another item, so compare identities
+		for (UPrimalItem* item : class_items.items)
+		{
+			const auto iter = index.items.find(item);
+			if (iter == index.items.end() ||
+				FWeakObjectPtr::Resolve(iter->second.object_index, iter->second.serial_number, true) !=
+				reinterpret_cast<UObject*>(item))
+			{
+				return false;
+			}
+		}
+
+		class_items.checked_generation = index.generation;
+		return true;
+	}
+
+	void InventoryIndex::Sweep()
+	{
+		for (auto iter = indices_.begin(); iter != indices_.end();)
+		{
+			const Index& index = iter->second;
+			if (FWeakObjectPtr::Resolve(index.object_index, index.serial_number, true) !=
+				reinterpret_cast<UObject*>(iter->first))
+			{
+				iter = indices_.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	void InventoryIndex::Add(Index& index, UPrimalItem* item)
+	{
+		UClass* item_class = GetItemClass(item);
+		const int quantity = item->GetItemQuantity();
+
+		const auto weak = GetWeakReference(reinterpret_cast<UObject*>(item));
+		const ItemEntry entry{item_class, quantity, weak.ObjectIndex, weak.ObjectSerialNumber};
+
+		if (!index.items.emplace(item, entry).second)
+		{
+			return;
+		}
+
+		ClassItems& class_items = index.classes[item_class];
+		class_items.items.push_back(item);
+		class_items.quantity += quantity;
+	}
+
+	void InventoryIndex::Remove(Index& index, UPrimalItem* item)
+	{
+		const auto iter = index.items.find(item);
+		if (iter == index.items.end())
+		{
+			return;
+		}
+
+		const auto class_iter = index.classes.find(iter->second.item_class);
+		if (class_iter != index.classes.end())
+		{
+			ClassItems& class_items = class_iter->second;
+
+			auto& items = class_items.items;
+			const auto item_iter = std::find(items.begin(), items.end(), item);
+			if (item_iter != items.end())
+			{
+				*item_iter = items.back();
+				items.pop_back();
+			}
+
+			class_items.quantity -= iter->second.quantity;
+
+			if (items.empty())
+			{
+				index.classes.erase(class_iter);
+			}
+		}
+
+		index.items.erase(iter);
+	}
+} // namespace API
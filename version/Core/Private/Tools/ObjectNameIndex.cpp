@@ -0,0 +1,285 @@
+#include <ObjectNameIndex.h>
+
+#include <IApiUtils.h>
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	// Slots visited per tick, a full pass over a loaded server takes a few seconds
+	constexpr int objects_per_tick = 16384;
+
+	namespace
+	{
+		FChunkedFixedUObjectArray& GetObjects()
+		{
+			static FChunkedFixedUObjectArray& objects = Globals::GUObjectArray()().ObjObjects;
+			return objects;
+		}
+
+		// Fields are read through cached offsets, the name lookup is too slow for a loop over every object
+		const FName& GetObjectName(UObject* object)
+		{
+			static const DWORD64 name_offset = GetAddress(nullptr, "UObjectBase.Name");
+			return *reinterpret_cast<const FName*>(reinterpret_cast<DWORD64>(object) + name_offset);
+		}
+
+		bool IsClass(UObject* object)
+		{
+			static const DWORD64 class_offset = GetAddress(nullptr, "UObjectBase.Class");
+			static const DWORD64 cast_flags_offset = GetAddress(nullptr, "UClass.ClassCastFlags");
+
+			const auto object_class = *reinterpret_cast<const DWORD64*>(reinterpret_cast<DWORD64>(object) +
+				class_offset);
+			if (object_class == 0)
+			{
+				return false;
+			}
+
+			const auto cast_flags = *reinterpret_cast<const unsigned long long*>(object_class + cast_flags_offset);
+			return (cast_flags & static_cast<unsigned long long>(ClassCastFlags::CASTCLASS_UClass)) != 0;
+		}
+	} // namespace
+
+	ObjectNameIndex::~ObjectNameIndex()
+	{
+		if (started_ && game_api)
+		{
+			game_api->GetCommands()->RemoveOnTickCallback("ObjectNameIndexUpdate");
+		}
+	}
+
+	ObjectNameIndex& ObjectNameIndex::Get()
+	{
+		static ObjectNameIndex instance;
+		return instance;
+	}
+
+	void ObjectNameIndex::Start()
+	{
+		if (!started_)
+		{
+			started_ = true;
+			game_api->GetCommands()->AddOnTickCallback("ObjectNameIndexUpdate",
+			                                           std::bind(&ObjectNameIndex::Update, this));
+		}
+	}
+
+	uint64_t ObjectNameIndex::NameKey(int comparison_index, unsigned int number)
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(comparison_index)) << 32 | number;
+	}
+
+	UClass* ObjectNameIndex::FindClass(const std::string& name)
+	{
+		Start();
+
+		// Misses compare every slot, a class can't exist if its short name was never added to the name table
+		const size_t separator = name.find_last_of(". ");
+		const std::string short_name = separator != std::string::npos ? name.substr(separator + 1) : name;
+		if (FName(short_name.c_str(), EFindName::FNAME_Find).ComparisonIndex == 0)
+		{
+			return nullptr;
+		}
+
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			if (const auto iter = classes_by_full_name_.find(name); iter != classes_by_full_name_.end())
+			{
+				if (UObject* object = GetLiveObject(iter->second))
+				{
+					return reinterpret_cast<UClass*>(object);
+				}
+			}
+
+			const auto range = classes_by_short_name_.equal_range(name);
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				if (UObject* object = GetLiveObject(iter->second))
+				{
+					return reinterpret_cast<UClass*>(object);
+				}
+			}
+
+			if (attempt == 0)
+			{
+				CatchUp();
+			}
+		}
+
+		return nullptr;
+	}
+
+	UObject* ObjectNameIndex::FindObjectByName(const std::string& name)
+	{
+		Start();
+
+		// Objects can't have a name which was never added to the name table
+		const FName fname(name.c_str(), EFindName::FNAME_Find);
+		if (fname.ComparisonIndex == 0)
+		{
+			return nullptr;
+		}
+
+		const uint64_t key = NameKey(fname.ComparisonIndex, fname.Number);
+
+		for (int attempt = 0; attempt < 2; ++attempt)
+		{
+			const auto range = objects_by_name_.equal_range(key);
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				if (UObject* object = GetLiveObject(iter->second))
+				{
+					return object;
+				}
+			}
+
+			if (attempt == 0)
+			{
+				CatchUp();
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool ObjectNameIndex::HasName(UObject* object, uint64_t name)
+	{
+		const FName& object_name = GetObjectName(object);
+		return NameKey(object_name.ComparisonIndex, object_name.Number) == name;
+	}
+
+	UObject* ObjectNameIndex::GetLiveObject(int index) const
+	{
+		FChunkedFixedUObjectArray& objects = GetObjects();
+		if (index >= objects.NumElements)
+		{
+			return nullptr;
+		}
+
+		// The slot is re-indexed by the next pass if another object took it
+		UObject* object = objects.GetObjectPtr(index)->Object;
+		if (object == nullptr || object != slots_[index].object)
+		{
+			return nullptr;
+		}
+
+		return HasName(object, slots_[index].name) ? object : nullptr;
+	}
+
+	void ObjectNameIndex::CatchUp()
+	{
+		// Objects created in freed slots, e.g. a blueprint class which was just loaded, would only be found when
+		// the rolling pass gets there. Every slot is compared, only slots whose object changed are indexed again
+		Scan(0, GetObjects().NumElements);
+		complete_ = true;
+	}
+
+	void ObjectNameIndex::Update()
+	{
+		const int num_elements = GetObjects().NumElements;
+		if (cursor_ >= num_elements)
+		{
+			cursor_ = 0;
+		}
+
+		const int end = (std::min)(cursor_ + objects_per_tick, num_elements);
+		Scan(cursor_, end);
+
+		cursor_ = end;
+		if (cursor_ >= num_elements)
+		{
+			cursor_ = 0;
+			complete_ = true;
+		}
+	}
+
+	void ObjectNameIndex::Scan(int begin, int end)
+	{
+		FChunkedFixedUObjectArray& objects = GetObjects();
+
+		if (static_cast<int>(slots_.size()) < end)
+		{
+			slots_.resize(end);
+		}
+
+		for (int index = begin; index < end; ++index)
+		{
+			UObject* object = objects.GetObjectPtr(index)->Object;
+			if (object != slots_[index].object || (object != nullptr && !HasName(object, slots_[index].name)))
+			{
+				RemoveSlot(index);
+				if (object != nullptr)
+				{
+					IndexSlot(index, object);
+				}
+			}
+		}
+	}
+
+	void ObjectNameIndex::IndexSlot(int index, UObject* object)
+	{
+		const FName& name = GetObjectName(object);
+
+		Slot& slot = slots_[index];
+		slot.object = object;
+		slot.name = NameKey(name.ComparisonIndex, name.Number);
+
+		objects_by_name_.emplace(slot.name, index);
+
+		if (!IsClass(object))
+		{
+			return;
+		}
+
+		FString full_name;
+		object->GetFullName(&full_name, nullptr);
+		slot.full_name = full_name.ToString();
+
+		classes_by_full_name_[slot.full_name] = index;
+
+		// "Class /Script/Engine.TriggerSphere" -> "TriggerSphere"
+		const size_t separator = slot.full_name.find_last_of(". ");
+		if (separator != std::string::npos)
+		{
+			classes_by_short_name_.emplace(slot.full_name.substr(separator + 1), index);
+		}
+	}
+
+	void ObjectNameIndex::RemoveSlot(int index)
+	{
+		Slot& slot = slots_[index];
+		if (slot.object == nullptr)
+		{
+			return;
+		}
+
+		const auto erase = [index](auto& map, const auto& key)
+		{
+			const auto range = map.equal_range(key);
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				if (iter->second == index)
+				{
+					map.erase(iter);
+					return;
+				}
+			}
+		};
+
+		erase(objects_by_name_, slot.name);
+
+		if (!slot.full_name.empty())
+		{
+			erase(classes_by_full_name_, slot.full_name);
+
+			const size_t separator = slot.full_name.find_last_of(". ");
+			if (separator != std::string::npos)
+			{
+				erase(classes_by_short_name_, slot.full_name.substr(separator + 1));
+			}
+		}
+
+		slot = Slot{};
+	}
+} // namespace API
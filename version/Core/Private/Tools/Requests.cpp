@@ -2,12 +2,24 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <Requests.h>
+#include <Tools.h>
+#include <FlightRecorder.h>
 
 #include "../IBaseApi.h"
+#include "ResponseCache.h"
+#include "../PluginManager/PluginStats.h"
 
 #include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
 
 #include <mutex>
+#include <unordered_set>
+
+#include <intrin.h>
 
 #include <Poco/Net/HTTPSClientSession.h>
 #include <Poco/Net/HTTPRequest.h>
@@ -17,33 +29,79 @@
 #include <Poco/URI.h>
 #include <Poco/Exception.h>
 #include <Poco/UTF8String.h>
+#include <Poco/String.h>
 #include <Poco/NullStream.h>
+#include <Poco/Timespan.h>
 #include <Poco/Net/SSLManager.h>
 #include <Poco/Net/InvalidCertificateHandler.h>
 #include <Poco/Net/RejectCertificateHandler.h>
 
+#pragma intrinsic(_ReturnAddress)
+
 namespace API
 {
 	class Requests::impl
 	{
 	public:
 		void WriteRequest(std::function<void(bool, std::string)> callback, bool success, std::string result);
+		void WriteCallback(std::function<void()> callback);
 
 		Poco::Net::HTTPRequest ConstructRequest(const std::string& url, Poco::Net::HTTPClientSession*& session,
 			const std::vector<std::string>& headers, const std::string& request_type);
 
-		std::string GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response);
+		/**
+		 * \brief Sends the request with the policy of the host, retrying idempotent methods
+		 * \return Response, status is 0 and reason is the error if no response was received
+		 */
+		Response Execute(const std::string& method, const std::string& url, const std::vector<std::string>& headers,
+			const std::string& body, const std::string& content_type);
+
+		/**
+		 * \brief Reads status, headers and body. The body is read in chunks and the read fails with
+		 * Poco::TimeoutException once the deadline has passed, so slow responses can't outlive total_timeout_ms
+		 */
+		Response ReadResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response,
+			const RequestPolicy& policy, std::chrono::steady_clock::time_point deadline);
+		Response ReadResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response,
+			ResponseSink& sink, const RequestPolicy& policy, std::chrono::steady_clock::time_point deadline);
+
+		static std::string ReadBody(std::istream& rs, const Poco::Net::HTTPResponse& response,
+			Poco::Net::HTTPClientSession& session, const RequestPolicy& policy,
+			std::chrono::steady_clock::time_point deadline);
+		static void CopyHeaders(const Poco::Net::HTTPResponse& response, Response& result);
+
+		static std::string GetHost(const std::string& url);
+		static bool IsIdempotent(const std::string& method);
+		static void ApplyTimeouts(Poco::Net::HTTPClientSession& session, const RequestPolicy& policy,
+			std::chrono::steady_clock::time_point deadline);
+		static int GetBackoffMs(const RequestPolicy& policy, int attempt, const Response& response);
+
+		RequestPolicy GetPolicy(const std::string& host);
+
+		/**
+		 * \brief Checks the circuit of the host before an attempt
+		 * \param probe Set to true if the attempt is the single probe of a half-open circuit
+		 * \return false if the attempt must fail fast
+		 */
+		bool AcquireCircuit(const std::string& host, const RequestPolicy& policy, bool retry, bool& probe);
+		void ReleaseCircuit(const std::string& host, const RequestPolicy& policy, bool failed, bool timed_out,
+			bool probe);
+
+		// Size of the chunks passed to ResponseSink::Write
+		static constexpr size_t stream_chunk_size = 64 * 1024;
 
 		void Update();
-	private:
-		struct RequestData
-		{
-			std::function<void(bool, std::string)> callback;
-			bool success;
-			std::string result;
-		};
 
-		std::vector<RequestData> RequestsVec_;
+		std::unique_ptr<ResponseCache> Cache;
+
+		RequestPolicy DefaultPolicy;
+		std::unordered_map<std::string, RequestPolicy> HostPolicies;
+		std::unordered_map<std::string, HostStats> Hosts;
+		std::unordered_set<std::string> HalfOpenProbes;
+		std::unordered_map<std::string, std::chrono::steady_clock::time_point> OpenedAt;
+		std::mutex PolicyMutex;
+	private:
+		std::vector<std::function<void()>> RequestsVec_;
 		std::mutex RequestMutex_;
 	};
 
@@ -55,6 +113,9 @@ namespace API
 		Poco::Net::Context::Ptr ptrContext = new Poco::Net::Context(Poco::Net::Context::TLS_CLIENT_USE, "", "", "", Poco::Net::Context::VERIFY_NONE, 9, false, "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
 		Poco::Net::SSLManager::instance().initializeClient(0, ptrCert, ptrContext);
 
+		pimpl->Cache = std::make_unique<ResponseCache>(
+			ArkApi::Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Cache/Requests");
+
 		game_api->GetCommands()->AddOnTickCallback("RequestsUpdate", std::bind(&impl::Update, this->pimpl.get())); 
 	}
 
@@ -71,9 +132,14 @@ namespace API
 	}
 
 	void Requests::impl::WriteRequest(std::function<void(bool, std::string)> callback, bool success, std::string result)
+	{
+		WriteCallback([callback, success, result = std::move(result)]() { callback(success, result); });
+	}
+
+	void Requests::impl::WriteCallback(std::function<void()> callback)
 	{
 		std::lock_guard<std::mutex> Guard(RequestMutex_);
-		RequestsVec_.push_back({ callback, success, result });
+		RequestsVec_.push_back(std::move(callback));
 	}
 
 	Poco::Net::HTTPRequest Requests::impl::ConstructRequest(const std::string& url, Poco::Net::HTTPClientSession*& session,
@@ -104,55 +170,449 @@ namespace API
 		return request;
 	}
 
-	std::string Requests::impl::GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response)
+	Response Requests::impl::Execute(const std::string& method, const std::string& url,
+		const std::vector<std::string>& headers, const std::string& body, const std::string& content_type)
+	{
+		const std::string host = GetHost(url);
+		const RequestPolicy policy = GetPolicy(host);
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(policy.total_timeout_ms);
+
+		Response result;
+
+		for (int attempt = 0;; ++attempt)
+		{
+			result = Response{};
+
+			bool probe = false;
+			if (!AcquireCircuit(host, policy, attempt > 0, probe))
+			{
+				result.reason = "Circuit open for " + host;
+				break;
+			}
+
+			Poco::Net::HTTPClientSession* session = nullptr;
+			bool timed_out = false;
+
+			try
+			{
+				Poco::Net::HTTPRequest&& request = ConstructRequest(url, session, headers, method);
+				ApplyTimeouts(*session, policy, deadline);
+
+				if (!body.empty())
+				{
+					request.setContentType(content_type);
+					request.setContentLength(body.length());
+
+					std::ostream& OutputStream = session->sendRequest(request);
+					OutputStream << body;
+				}
+				else
+				{
+					session->sendRequest(request);
+				}
+
+				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+				result = ReadResponse(session, response, policy, deadline);
+			}
+			catch (const Poco::TimeoutException& exc)
+			{
+				LOG_RATE_LIMITED(spdlog::level::err, 5000, "{} {} - {}", method, url, exc.displayText());
+				result.reason = exc.displayText();
+				timed_out = true;
+			}
+			catch (const Poco::Exception& exc)
+			{
+				LOG_RATE_LIMITED(spdlog::level::err, 5000, exc.displayText());
+				result.reason = exc.displayText();
+			}
+
+			delete session;
+			session = nullptr;
+
+			ReleaseCircuit(host, policy, result.status == 0 || result.status >= 500, timed_out, probe);
+
+			const bool retryable = result.status == 0 || result.status == 429
+				|| (result.status >= 502 && result.status <= 504);
+
+			if (!retryable || !IsIdempotent(method) || attempt >= policy.max_retries)
+				break;
+
+			const auto delay = std::chrono::milliseconds(GetBackoffMs(policy, attempt, result));
+			if (std::chrono::steady_clock::now() + delay >= deadline)
+				break;
+
+			std::this_thread::sleep_for(delay);
+		}
+
+		// Only the host, paths and queries often contain tokens
+		FlightRecorder::Get().Record(FlightRecorder::Category::Request,
+		                             method + " " + host + " " + std::to_string(result.status));
+
+		return result;
+	}
+
+	std::string Requests::impl::GetHost(const std::string& url)
+	{
+		try
+		{
+			return Poco::toLower(Poco::URI(url).getHost());
+		}
+		catch (const Poco::Exception&)
+		{
+			return "";
+		}
+	}
+
+	bool Requests::impl::IsIdempotent(const std::string& method)
+	{
+		return method == Poco::Net::HTTPRequest::HTTP_GET
+			|| method == Poco::Net::HTTPRequest::HTTP_HEAD
+			|| method == Poco::Net::HTTPRequest::HTTP_PUT
+			|| method == Poco::Net::HTTPRequest::HTTP_DELETE
+			|| method == Poco::Net::HTTPRequest::HTTP_OPTIONS;
+	}
+
+	void Requests::impl::ApplyTimeouts(Poco::Net::HTTPClientSession& session, const RequestPolicy& policy,
+		std::chrono::steady_clock::time_point deadline)
+	{
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now()).count();
+
+		if (remaining <= 0)
+			throw Poco::TimeoutException("Total timeout exceeded");
+
+		const auto to_timespan = [remaining](int timeout_ms)
+		{
+			return Poco::Timespan(static_cast<Poco::Timespan::TimeDiff>((std::min)(
+				static_cast<long long>(timeout_ms), static_cast<long long>(remaining))) * 1000);
+		};
+
+		session.setTimeout(to_timespan(policy.connect_timeout_ms), to_timespan(policy.read_timeout_ms),
+			to_timespan(policy.read_timeout_ms));
+	}
+
+	int Requests::impl::GetBackoffMs(const RequestPolicy& policy, int attempt, const Response& response)
+	{
+		// Seconds form of Retry-After only, HTTP dates fall back to backoff
+		const std::string retry_after = response.GetHeader("retry-after");
+		if (!retry_after.empty())
+		{
+			try
+			{
+				return (std::min)(static_cast<int>(std::stod(retry_after) * 1000), policy.max_backoff_ms);
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+
+		static thread_local std::mt19937 generator{std::random_device{}()};
+		std::uniform_real_distribution<double> jitter(0.5, 1.0);
+
+		const double backoff = (std::min)(static_cast<double>(policy.max_backoff_ms),
+			policy.base_backoff_ms * std::pow(2.0, attempt));
+
+		return static_cast<int>(backoff * jitter(generator));
+	}
+
+	RequestPolicy Requests::impl::GetPolicy(const std::string& host)
+	{
+		std::lock_guard<std::mutex> Guard(PolicyMutex);
+
+		const auto iter = HostPolicies.find(host);
+		return iter != HostPolicies.end() ? iter->second : DefaultPolicy;
+	}
+
+	bool Requests::impl::AcquireCircuit(const std::string& host, const RequestPolicy& policy, bool retry,
+		bool& probe)
+	{
+		std::lock_guard<std::mutex> Guard(PolicyMutex);
+
+		probe = false;
+
+		HostStats& stats = Hosts[host];
+
+		if (stats.state == CircuitState::Open)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if (now - OpenedAt[host] < std::chrono::milliseconds(policy.breaker_open_ms))
+			{
+				++stats.rejected;
+				return false;
+			}
+
+			stats.state = CircuitState::HalfOpen;
+			Log::GetLog()->info("Circuit for {} is half-open", host);
+		}
+
+		// Only one probe is allowed while half-open
+		if (stats.state == CircuitState::HalfOpen)
+		{
+			if (!HalfOpenProbes.insert(host).second)
+			{
+				++stats.rejected;
+				return false;
+			}
+
+			probe = true;
+		}
+
+		++stats.attempts;
+		if (retry)
+			++stats.retries;
+
+		return true;
+	}
+
+	void Requests::impl::ReleaseCircuit(const std::string& host, const RequestPolicy& policy, bool failed,
+		bool timed_out, bool probe)
+	{
+		std::lock_guard<std::mutex> Guard(PolicyMutex);
+
+		HostStats& stats = Hosts[host];
+
+		// Requests started before the circuit opened must not let another probe through
+		if (probe)
+			HalfOpenProbes.erase(host);
+
+		if (timed_out)
+			++stats.timeouts;
+
+		if (!failed)
+		{
+			if (stats.state != CircuitState::Closed)
+				Log::GetLog()->info("Circuit for {} is closed", host);
+
+			stats.state = CircuitState::Closed;
+			stats.consecutive_failures = 0;
+			return;
+		}
+
+		++stats.failures;
+		++stats.consecutive_failures;
+
+		const bool trip = stats.state == CircuitState::HalfOpen
+			|| (policy.breaker_failure_threshold > 0
+				&& stats.consecutive_failures >= policy.breaker_failure_threshold);
+
+		if (trip)
+		{
+			if (stats.state != CircuitState::Open)
+				Log::GetLog()->warn("Circuit for {} is open after {} failures", host, stats.consecutive_failures);
+
+			stats.state = CircuitState::Open;
+			OpenedAt[host] = std::chrono::steady_clock::now();
+		}
+	}
+
+	void Requests::SetDefaultPolicy(const RequestPolicy& policy)
+	{
+		std::lock_guard<std::mutex> Guard(pimpl->PolicyMutex);
+		pimpl->DefaultPolicy = policy;
+	}
+
+	void Requests::SetHostPolicy(const std::string& host, const RequestPolicy& policy)
+	{
+		std::lock_guard<std::mutex> Guard(pimpl->PolicyMutex);
+		pimpl->HostPolicies[Poco::toLower(host)] = policy;
+	}
+
+	std::unordered_map<std::string, HostStats> Requests::GetHostStats()
+	{
+		std::lock_guard<std::mutex> Guard(pimpl->PolicyMutex);
+		return pimpl->Hosts;
+	}
+
+	Response Requests::impl::ReadResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response,
+		const RequestPolicy& policy, std::chrono::steady_clock::time_point deadline)
+	{
+		Response result;
+
+		std::istream& rs = session->receiveResponse(response);
+
+		result.status = static_cast<int>(response.getStatus());
+		result.reason = response.getReason();
+		result.body = ReadBody(rs, response, *session, policy, deadline);
+
+		CopyHeaders(response, result);
+
+		return result;
+	}
+
+	Response Requests::impl::ReadResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response,
+		ResponseSink& sink, const RequestPolicy& policy, std::chrono::steady_clock::time_point deadline)
 	{
-		std::string result = "";
+		Response result;
 
 		std::istream& rs = session->receiveResponse(response);
 
-		if (response.getStatus() == Poco::Net::HTTPResponse::HTTP_OK)
+		result.status = static_cast<int>(response.getStatus());
+		result.reason = response.getReason();
+
+		CopyHeaders(response, result);
+
+		bool success = result.status >= 200 && result.status < 300 && sink.Begin(result);
+		if (success)
 		{
-			std::ostringstream oss;
-			Poco::StreamCopier::copyStream(rs, oss);
-			result = oss.str();
+			std::vector<char> buffer(stream_chunk_size);
+
+			while (rs.read(buffer.data(), buffer.size()) || rs.gcount() > 0)
+			{
+				if (!sink.Write(buffer.data(), static_cast<size_t>(rs.gcount())))
+				{
+					success = false;
+					break;
+				}
+
+				ApplyTimeouts(*session, policy, deadline);
+			}
+
+			success = success && !rs.bad();
 		}
 		else
 		{
-			Poco::NullOutputStream null;
-			Poco::StreamCopier::copyStream(rs, null);
-			result = std::to_string(response.getStatus()) + " " + response.getReason();
+			ReadBody(rs, response, *session, policy, deadline);
 		}
 
+		// Signal failure to the callback if the sink aborted a successful response
+		if (!success && result.status >= 200 && result.status < 300)
+		{
+			result.status = 0;
+			result.reason = "Aborted by sink";
+		}
+
+		result.body = sink.Finish(success);
+
 		return result;
 	}
 
-	bool Requests::CreateGetRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
-		std::vector<std::string> headers)
+	std::string Requests::impl::ReadBody(std::istream& rs, const Poco::Net::HTTPResponse& response,
+		Poco::Net::HTTPClientSession& session, const RequestPolicy& policy,
+		std::chrono::steady_clock::time_point deadline)
+	{
+		std::string body;
+
+		if (response.hasContentLength() && response.getContentLength64() > 0)
+		{
+			body.reserve(static_cast<size_t>(response.getContentLength64()));
+		}
+
+		std::vector<char> buffer(stream_chunk_size);
+
+		// Socket timeouts apply per read, a slowly dripping body is stopped by the deadline between chunks
+		while (rs.read(buffer.data(), buffer.size()) || rs.gcount() > 0)
+		{
+			body.append(buffer.data(), static_cast<size_t>(rs.gcount()));
+
+			ApplyTimeouts(session, policy, deadline);
+		}
+
+		return body;
+	}
+
+	void Requests::impl::CopyHeaders(const Poco::Net::HTTPResponse& response, Response& result)
+	{
+		for (const auto& header : response)
+		{
+			result.headers[Poco::toLower(header.first)] = header.second;
+		}
+	}
+
+	FileSink::FileSink(std::string path)
+		: path_(std::move(path)),
+		  temp_path_(path_ + ".part")
+	{
+	}
+
+	bool FileSink::Begin(const Response& /*response*/)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+
+		const fs::path parent = fs::path(path_).parent_path();
+		if (!parent.empty())
+		{
+			fs::create_directories(parent, error);
+		}
+
+		file_.open(temp_path_, std::ios::binary | std::ios::trunc);
+		if (!file_.is_open())
+		{
+			Log::GetLog()->error("({}) Failed to open {}", __FUNCTION__, temp_path_);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FileSink::Write(const char* data, size_t size)
+	{
+		file_.write(data, static_cast<std::streamsize>(size));
+		return file_.good();
+	}
+
+	std::string FileSink::Finish(bool success)
 	{
-		std::thread([this, url, callback, headers]
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+
+		if (file_.is_open())
+		{
+			file_.close();
+			success = success && !file_.fail();
+		}
+		else
+		{
+			success = false;
+		}
+
+		if (success)
+		{
+			fs::rename(temp_path_, path_, error);
+			if (!error)
 			{
-				std::string Result = "";
-				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-				Poco::Net::HTTPClientSession* session = nullptr;
+				return path_;
+			}
 
-				try
-				{
-					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_GET);
+			Log::GetLog()->error("({}) Failed to move {} - {}", __FUNCTION__, temp_path_, error.message());
+		}
 
-					session->sendRequest(request);
-					Result = pimpl->GetResponse(session, response);
-				}
-				catch (const Poco::Exception& exc)
-				{
-					Log::GetLog()->error(exc.displayText());
-				}
+		fs::remove(temp_path_, error);
 
-				const bool success = (int)response.getStatus() >= 200
-					&& (int)response.getStatus() < 300;
+		return "";
+	}
 
-				pimpl->WriteRequest(callback, success, Result);
-				delete session;
-				session = nullptr;
+	namespace
+	{
+		// Result of the string callbacks, body of 200 responses and the error otherwise
+		std::string GetResult(const Response& response)
+		{
+			if (response.status == Poco::Net::HTTPResponse::HTTP_OK)
+				return response.body;
+
+			if (response.status != 0)
+				return std::to_string(response.status) + " " + response.reason;
+
+			return response.reason;
+		}
+	} // namespace
+
+	bool Requests::CreateGetRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
+		std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+		PluginStats::Get().BeginRequest(owner);
+
+		std::thread([this, url, callback, headers, owner]
+			{
+				const Response Result = pimpl->Execute(Poco::Net::HTTPRequest::HTTP_GET, url, headers, "", "");
+				pimpl->WriteRequest(PluginStats::Track(owner, callback), Result.status >= 200 && Result.status < 300,
+				                    GetResult(Result));
+				PluginStats::Get().EndRequest(owner);
 			}
 		).detach();
 
@@ -162,158 +622,336 @@ namespace API
 	bool Requests::CreatePostRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
 		const std::string& post_data, std::vector<std::string> headers)
 	{
-		std::thread([this, url, callback, post_data, headers]
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		return CreatePostRequest(url, callback, post_data, "application/x-www-form-urlencoded", std::move(headers));
+	}
+
+	bool Requests::CreatePostRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
+		const std::string& post_data, const std::string& content_type, std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+		PluginStats::Get().BeginRequest(owner);
+
+		std::thread([this, url, callback, post_data, content_type, headers, owner]
 			{
-				std::string Result = "";
-				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-				Poco::Net::HTTPClientSession* session = nullptr;
+				const Response Result = pimpl->Execute(Poco::Net::HTTPRequest::HTTP_POST, url, headers, post_data,
+					content_type);
+				pimpl->WriteRequest(PluginStats::Track(owner, callback), Result.status >= 200 && Result.status < 300,
+				                    GetResult(Result));
+				PluginStats::Get().EndRequest(owner);
+			}
+		).detach();
 
-				try
-				{
-					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_POST);
+		return true;
+	}
 
-					request.setContentType("application/x-www-form-urlencoded");
-					request.setContentLength(post_data.length());
+	bool Requests::CreatePostRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
+		const std::vector<std::string>& post_ids,
+		const std::vector<std::string>& post_data, std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
 
-					std::ostream& OutputStream = session->sendRequest(request);
-					OutputStream << post_data;
+		if (post_ids.size() != post_data.size())
+			return false;
 
-					Result = pimpl->GetResponse(session, response);
-				}
-				catch (const Poco::Exception& exc)
-				{
-					Log::GetLog()->error(exc.displayText());
-				}
+		std::string body;
+
+		for (size_t i = 0; i < post_ids.size(); ++i)
+		{
+			const std::string& id = post_ids[i];
+			const std::string& data = post_data[i];
 
-				const bool success = (int)response.getStatus() >= 200
-					&& (int)response.getStatus() < 300;
+			body += fmt::format("{}={}&", Poco::UTF8::escape(id), Poco::UTF8::escape(data));
+		}
 
-				pimpl->WriteRequest(callback, success, Result);
-				delete session;
-				session = nullptr;
+		if (!body.empty())
+			body.pop_back(); // Remove last '&'
+
+		return CreatePostRequest(url, callback, body, "application/x-www-form-urlencoded", std::move(headers));
+	}
+
+	bool Requests::CreateDeleteRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
+		std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+		PluginStats::Get().BeginRequest(owner);
+
+		std::thread([this, url, callback, headers, owner]
+			{
+				const Response Result = pimpl->Execute(Poco::Net::HTTPRequest::HTTP_DELETE, url, headers, "", "");
+				pimpl->WriteRequest(PluginStats::Track(owner, callback), Result.status >= 200 && Result.status < 300,
+				                    GetResult(Result));
+				PluginStats::Get().EndRequest(owner);
 			}
 		).detach();
 
 		return true;
 	}
 
-	bool Requests::CreatePostRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
-		const std::string& post_data, const std::string& content_type, std::vector<std::string> headers)
+	bool Requests::CreateCachedGetRequest(const std::string& url,
+		const std::function<void(bool, std::string)>& callback, std::vector<std::string> headers,
+		const CacheOptions& options)
 	{
-		std::thread([this, url, callback, post_data, content_type, headers]
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		ResponseCache& cache = *pimpl->Cache;
+
+		const std::string key = ResponseCache::MakeKey(url, headers, options.vary_headers);
+
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+
+		std::optional<CacheEntry> entry = cache.FindInMemory(key);
+		if (entry && entry->IsFresh(time(nullptr)))
+		{
+			pimpl->WriteRequest(PluginStats::Track(owner, callback), true, entry->body);
+			return true;
+		}
+
+		// Another request for the same key is running, it will answer this callback as well
+		if (!cache.BeginFetch(key, PluginStats::Track(owner, callback)))
+			return true;
+
+		PluginStats::Get().BeginRequest(owner);
+
+		std::thread([this, url, key, headers, options, entry, owner]() mutable
 			{
-				std::string Result = "";
-				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-				Poco::Net::HTTPClientSession* session = nullptr;
+				ResponseCache& cache = *pimpl->Cache;
 
-				try
+				// Another server may have refreshed the shared disk entry
+				if (options.use_disk)
 				{
-					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_POST);
+					std::optional<CacheEntry> disk_entry = cache.LoadFromDisk(key);
+					if (disk_entry && (!entry || disk_entry->expires > entry->expires))
+					{
+						entry = std::move(disk_entry);
+					}
+				}
 
-					request.setContentType(content_type);
-					request.setContentLength(post_data.length());
+				bool success = false;
+				std::string Result;
 
-					std::ostream& OutputStream = session->sendRequest(request);
-					OutputStream << post_data;
+				if (entry && entry->IsFresh(time(nullptr)))
+				{
+					cache.Store(*entry, false, options.max_memory_entries);
 
-					Result = pimpl->GetResponse(session, response);
+					success = true;
+					Result = entry->body;
 				}
-				catch (const Poco::Exception& exc)
+				else
 				{
-					Log::GetLog()->error(exc.displayText());
+					if (entry)
+					{
+						if (!entry->etag.empty())
+							headers.push_back("If-None-Match:" + entry->etag);
+						if (!entry->last_modified.empty())
+							headers.push_back("If-Modified-Since:" + entry->last_modified);
+					}
+
+					Response response_data = pimpl->Execute(Poco::Net::HTTPRequest::HTTP_GET, url, headers, "", "");
+
+					if (response_data.status == Poco::Net::HTTPResponse::HTTP_NOT_MODIFIED && entry)
+					{
+						if (ResponseCache::UpdateFromResponse(response_data, options.default_ttl_seconds, *entry))
+							cache.Store(*entry, options.use_disk, options.max_memory_entries);
+
+						success = true;
+						Result = entry->body;
+					}
+					else if (response_data.status >= 200 && response_data.status < 300)
+					{
+						CacheEntry new_entry;
+						new_entry.key = key;
+						new_entry.body = std::move(response_data.body);
+
+						if (ResponseCache::UpdateFromResponse(response_data, options.default_ttl_seconds, new_entry))
+							cache.Store(new_entry, options.use_disk, options.max_memory_entries);
+
+						success = true;
+						Result = std::move(new_entry.body);
+					}
+					else
+					{
+						Result = GetResult(response_data);
+					}
 				}
 
-				const bool success = (int)response.getStatus() >= 200
-					&& (int)response.getStatus() < 300;
+				for (auto& waiter : cache.EndFetch(key))
+				{
+					pimpl->WriteRequest(std::move(waiter), success, Result);
+				}
 
-				pimpl->WriteRequest(callback, success, Result);
-				delete session;
-				session = nullptr;
+				PluginStats::Get().EndRequest(owner);
 			}
 		).detach();
 
 		return true;
 	}
 
-	bool Requests::CreatePostRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
-		const std::vector<std::string>& post_ids,
-		const std::vector<std::string>& post_data, std::vector<std::string> headers)
+	bool Requests::CreateRequest(const std::string& method, const std::string& url,
+		const std::function<void(bool, Response)>& callback, const std::string& body, const std::string& content_type,
+		std::vector<std::string> headers)
 	{
-		if (post_ids.size() != post_data.size())
-			return false;
+		PluginStats::CallerScope caller(_ReturnAddress());
 
-		std::thread([this, url, callback, post_ids, post_data, headers]
+		return CreateTransformRequestInternal(method, url,
+			[callback](bool success, Response& response) -> std::function<void()>
 			{
-				std::string Result = "";
-				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-				Poco::Net::HTTPClientSession* session = nullptr;
-
-				try
-				{
-					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_POST);
-
-					std::string body;
+				return [callback, success, response = std::move(response)]() { callback(success, response); };
+			}, body, content_type, std::move(headers));
+	}
 
-					for (size_t i = 0; i < post_ids.size(); ++i)
-					{
-						const std::string& id = post_ids[i];
-						const std::string& data = post_data[i];
+	bool Requests::CreateTransformRequestInternal(const std::string& method, const std::string& url,
+		const std::function<std::function<void()>(bool, Response&)>& worker, const std::string& body,
+		const std::string& content_type, std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
 
-						body += fmt::format("{}={}&", Poco::UTF8::escape(id), Poco::UTF8::escape(data));
-					}
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+		PluginStats::Get().BeginRequest(owner);
 
-					body.pop_back(); // Remove last '&'
+		std::thread([this, method, url, worker, body, content_type, headers, owner]
+			{
+				Response Result = pimpl->Execute(method, url, headers, body, content_type);
 
-					request.setContentType("application/x-www-form-urlencoded");
-					request.setContentLength(body.size());
+				const bool success = Result.status >= 200
+					&& Result.status < 300;
 
-					std::ostream& OutputStream = session->sendRequest(request);
-					OutputStream << body;
+				// Heavy post-processing runs here, the main thread only gets the finished result
+				std::function<void()> completion;
 
-					Result = pimpl->GetResponse(session, response);
+				try
+				{
+					completion = worker(success, Result);
 				}
-				catch (const Poco::Exception& exc)
+				catch (const std::exception& error)
 				{
-					Log::GetLog()->error(exc.displayText());
+					Log::GetLog()->error("({}) Failed to process response from {} - {}", __FUNCTION__, url, error.what());
+					completion = worker(false, Result);
 				}
 
-				const bool success = (int)response.getStatus() >= 200
-					&& (int)response.getStatus() < 300;
-
-				pimpl->WriteRequest(callback, success, Result);
-				delete session;
-				session = nullptr;
+				pimpl->WriteCallback(PluginStats::Track(owner, std::move(completion)));
+				PluginStats::Get().EndRequest(owner);
 			}
 		).detach();
 
 		return true;
 	}
 
-	bool Requests::CreateDeleteRequest(const std::string& url, const std::function<void(bool, std::string)>& callback,
-		std::vector<std::string> headers)
+	bool Requests::CreateStreamRequest(const std::string& method, const std::string& url,
+		std::shared_ptr<ResponseSink> sink, const std::function<void(bool, Response)>& callback,
+		const std::string& body, const std::string& content_type, std::vector<std::string> headers)
 	{
-		std::thread([this, url, callback, headers]
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		if (!sink)
+			return false;
+
+		const HMODULE owner = PluginStats::GetCurrentOwner();
+		PluginStats::Get().BeginRequest(owner);
+
+		std::thread([this, method, url, sink, callback, body, content_type, headers, owner]
 			{
-				std::string Result = "";
+				Response Result;
 				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
 				Poco::Net::HTTPClientSession* session = nullptr;
+				bool finished = false;
+				bool timed_out = false;
+
+				// Streams are never retried, the sink may already have received a part of the body
+				const std::string host = impl::GetHost(url);
+				const RequestPolicy policy = pimpl->GetPolicy(host);
+				bool probe = false;
+				const bool acquired = pimpl->AcquireCircuit(host, policy, false, probe);
 
 				try
 				{
-					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_DELETE);
+					if (!acquired)
+						throw Poco::Exception("Circuit open for " + host);
 
-					session->sendRequest(request);
-					Result = pimpl->GetResponse(session, response);
+					const auto deadline = std::chrono::steady_clock::now()
+						+ std::chrono::milliseconds(policy.total_timeout_ms);
+
+					Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, method);
+					impl::ApplyTimeouts(*session, policy, deadline);
+
+					if (!body.empty())
+					{
+						request.setContentType(content_type);
+						request.setContentLength(body.length());
+
+						std::ostream& OutputStream = session->sendRequest(request);
+						OutputStream << body;
+					}
+					else
+					{
+						session->sendRequest(request);
+					}
+
+					Result = pimpl->ReadResponse(session, response, *sink, policy, deadline);
+					finished = true;
+				}
+				catch (const Poco::TimeoutException& exc)
+				{
+					LOG_RATE_LIMITED(spdlog::level::err, 5000, "{} {} - {}", method, url, exc.displayText());
+					Result.status = 0;
+					Result.reason = exc.displayText();
+					timed_out = true;
 				}
 				catch (const Poco::Exception& exc)
 				{
-					Log::GetLog()->error(exc.displayText());
+					LOG_RATE_LIMITED(spdlog::level::err, 5000, exc.displayText());
+					Result.status = 0;
+					Result.reason = exc.displayText();
+				}
+				// Sinks are plugin code, anything they throw must not escape the thread
+				catch (const std::exception& error)
+				{
+					Log::GetLog()->error("({}) Failed to stream response from {} - {}", __FUNCTION__, url, error.what());
+					Result.status = 0;
+					Result.reason = error.what();
+				}
+				catch (...)
+				{
+					Log::GetLog()->error("({}) Failed to stream response from {} - unknown exception", __FUNCTION__,
+					                     url);
+					Result.status = 0;
+					Result.reason = "Unknown exception";
 				}
 
-				const bool success = (int)response.getStatus() >= 200
-					&& (int)response.getStatus() < 300;
+				// Sink must always be finished, even if the connection failed mid-way
+				if (!finished)
+				{
+					try
+					{
+						Result.body = sink->Finish(false);
+					}
+					catch (const std::exception& error)
+					{
+						Log::GetLog()->error("({}) Sink failed to finish {} - {}", __FUNCTION__, url, error.what());
+					}
+					catch (...)
+					{
+						Log::GetLog()->error("({}) Sink failed to finish {} - unknown exception", __FUNCTION__, url);
+					}
+				}
+
+				if (acquired)
+				{
+					// Aborts by the sink are not a failure of the host
+					pimpl->ReleaseCircuit(host, policy, !finished || Result.status >= 500, timed_out, probe);
+				}
+
+				const bool success = Result.status >= 200
+					&& Result.status < 300;
 
-				pimpl->WriteRequest(callback, success, Result);
+				pimpl->WriteCallback(PluginStats::Track(owner, std::function<void()>(
+					[callback, success, Result = std::move(Result)]() { callback(success, Result); })));
+				PluginStats::Get().EndRequest(owner);
 				delete session;
 				session = nullptr;
 			}
@@ -322,15 +960,30 @@ namespace API
 		return true;
 	}
 
+	bool Requests::CreateDownloadRequest(const std::string& url, const std::string& file_path,
+		const std::function<void(bool, std::string)>& callback, std::vector<std::string> headers)
+	{
+		PluginStats::CallerScope caller(_ReturnAddress());
+
+		return CreateStreamRequest(Poco::Net::HTTPRequest::HTTP_GET, url, std::make_shared<FileSink>(file_path),
+			[callback](bool success, Response response)
+			{
+				if (success)
+					callback(true, response.body);
+				else
+					callback(false, std::to_string(response.status) + " " + response.reason);
+			}, "", "", std::move(headers));
+	}
+
 	void Requests::impl::Update()
 	{
 		if (RequestsVec_.empty())
 			return;
 
 		RequestMutex_.lock();
-		std::vector<RequestData> requests_temp = std::move(RequestsVec_);
+		std::vector<std::function<void()>> requests_temp = std::move(RequestsVec_);
 		RequestMutex_.unlock();
 
-		for (const auto& request : requests_temp) { request.callback(request.success, request.result); }
+		for (const auto& request : requests_temp) { request(); }
 	}
 } // namespace API
\ No newline at end of file
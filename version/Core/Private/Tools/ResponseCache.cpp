@@ -0,0 +1,242 @@
+#include "ResponseCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <windows.h>
+
+#include <Logger/Logger.h>
+
+#include "json.hpp"
+
+#include <Poco/String.h>
+
+namespace API
+{
+	ResponseCache::ResponseCache(std::string directory)
+		: directory_(std::move(directory))
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory_, error);
+	}
+
+	std::string ResponseCache::MakeKey(const std::string& url, const std::vector<std::string>& headers,
+	                                   const std::vector<std::string>& vary_headers)
+	{
+		std::string key = url;
+
+		for (const auto& vary : vary_headers)
+		{
+			key += '\n' + Poco::toLower(vary) + ':';
+
+			for (const auto& header : headers)
+			{
+				const auto pos = header.find(':');
+				if (pos != std::string::npos && Poco::icompare(header.substr(0, pos), vary) == 0)
+				{
+					key += Poco::trim(header.substr(pos + 1));
+					break;
+				}
+			}
+		}
+
+		return key;
+	}
+
+	bool ResponseCache::UpdateFromResponse(const Response& response, int default_ttl_seconds, CacheEntry& entry)
+	{
+		const std::string cache_control = Poco::toLower(response.GetHeader("cache-control"));
+
+		if (cache_control.find("no-store") != std::string::npos)
+		{
+			return false;
+		}
+
+		int ttl = default_ttl_seconds;
+
+		const auto max_age = cache_control.find("max-age=");
+		if (max_age != std::string::npos)
+		{
+			try
+			{
+				ttl = std::stoi(cache_control.substr(max_age + 8));
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+
+		if (cache_control.find("no-cache") != std::string::npos)
+		{
+			ttl = 0;
+		}
+
+		const std::string etag = response.GetHeader("etag");
+		const std::string last_modified = response.GetHeader("last-modified");
+
+		// 304 may omit validators, keep the old ones
+		if (!etag.empty())
+			entry.etag = etag;
+		if (!last_modified.empty())
+			entry.last_modified = last_modified;
+
+		entry.expires = time(nullptr) + (ttl > 0 ? ttl : 0);
+
+		// Without TTL or validators the entry could never be used
+		return ttl > 0 || !entry.etag.empty() || !entry.last_modified.empty();
+	}
+
+	std::optional<CacheEntry> ResponseCache::FindInMemory(const std::string& key)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		const auto iter = entries_.find(key);
+		if (iter == entries_.end())
+		{
+			return std::nullopt;
+		}
+
+		return iter->second;
+	}
+
+	std::optional<CacheEntry> ResponseCache::LoadFromDisk(const std::string& key) const
+	{
+		std::ifstream file{GetFilePath(key), std::ios::binary};
+		if (!file.is_open())
+		{
+			return std::nullopt;
+		}
+
+		try
+		{
+			// First line is metadata, the rest of the file is the raw body
+			std::string meta_line;
+			std::getline(file, meta_line);
+
+			const auto meta = nlohmann::json::parse(meta_line);
+			if (meta.value("key", "") != key)
+			{
+				return std::nullopt;
+			}
+
+			CacheEntry entry;
+			entry.key = key;
+			entry.etag = meta.value("etag", "");
+			entry.last_modified = meta.value("last_modified", "");
+			entry.expires = meta.value("expires", static_cast<time_t>(0));
+
+			std::ostringstream body;
+			body << file.rdbuf();
+			entry.body = body.str();
+
+			if (entry.body.size() != meta.value("size", static_cast<size_t>(0)))
+			{
+				return std::nullopt;
+			}
+
+			return entry;
+		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+		}
+
+		return std::nullopt;
+	}
+
+	void ResponseCache::Store(const CacheEntry& entry, bool write_to_disk, size_t max_memory_entries)
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+
+			if (entries_.size() >= max_memory_entries && entries_.find(entry.key) == entries_.end())
+			{
+				// Evict the entry which expires first
+				const auto oldest = std::min_element(entries_.begin(), entries_.end(),
+				                                     [](const auto& left, const auto& right)
+				                                     {
+					                                     return left.second.expires < right.second.expires;
+				                                     });
+				if (oldest != entries_.end())
+				{
+					entries_.erase(oldest);
+				}
+			}
+
+			entries_[entry.key] = entry;
+		}
+
+		if (!write_to_disk)
+		{
+			return;
+		}
+
+		namespace fs = std::filesystem;
+
+		const std::string path = GetFilePath(entry.key);
+		const std::string temp_path = path + "." + std::to_string(GetCurrentProcessId()) + ".tmp";
+
+		const nlohmann::json meta{
+			{"key", entry.key},
+			{"etag", entry.etag},
+			{"last_modified", entry.last_modified},
+			{"expires", entry.expires},
+			{"size", entry.body.size()}
+		};
+
+		{
+			std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+			if (!file.is_open())
+			{
+				return;
+			}
+
+			file << meta.dump() << '\n';
+			file.write(entry.body.data(), static_cast<std::streamsize>(entry.body.size()));
+		}
+
+		// Rename is atomic, other processes never see a partially written file
+		std::error_code error;
+		fs::rename(temp_path, path, error);
+		if (error)
+		{
+			fs::remove(temp_path, error);
+		}
+	}
+
+	bool ResponseCache::BeginFetch(const std::string& key, Callback callback)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		auto& waiters = in_flight_[key];
+		waiters.push_back(std::move(callback));
+
+		return waiters.size() == 1;
+	}
+
+	std::vector<ResponseCache::Callback> ResponseCache::EndFetch(const std::string& key)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		std::vector<Callback> waiters;
+
+		const auto iter = in_flight_.find(key);
+		if (iter != in_flight_.end())
+		{
+			waiters = std::move(iter->second);
+			in_flight_.erase(iter);
+		}
+
+		return waiters;
+	}
+
+	std::string ResponseCache::GetFilePath(const std::string& key) const
+	{
+		char name[17];
+		sprintf_s(name, "%016llx", static_cast<unsigned long long>(std::hash<std::string>{}(key)));
+
+		return directory_ + "/" + name + ".cache";
+	}
+} // namespace API
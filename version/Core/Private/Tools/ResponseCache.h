@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Requests.h>
+
+namespace API
+{
+	struct CacheEntry
+	{
+		std::string key;
+		std::string body;
+		std::string etag;
+		std::string last_modified;
+		time_t expires{0};
+
+		bool IsFresh(time_t now) const { return now < expires; }
+	};
+
+	/**
+	 * \brief Memory and on-disk storage for Requests::CreateCachedGetRequest.
+	 * The disk tier is shared by all server processes that run from the same directory
+	 */
+	class ResponseCache
+	{
+	public:
+		using Callback = std::function<void(bool, std::string)>;
+
+		explicit ResponseCache(std::string directory);
+
+		ResponseCache(const ResponseCache&) = delete;
+		ResponseCache(ResponseCache&&) = delete;
+		ResponseCache& operator=(const ResponseCache&) = delete;
+		ResponseCache& operator=(ResponseCache&&) = delete;
+
+		static std::string MakeKey(const std::string& url, const std::vector<std::string>& headers,
+		                           const std::vector<std::string>& vary_headers);
+
+		/**
+		 * \brief Updates validators and expiry time of the entry from response headers
+		 * \return false if the response must not be stored
+		 */
+		static bool UpdateFromResponse(const Response& response, int default_ttl_seconds, CacheEntry& entry);
+
+		std::optional<CacheEntry> FindInMemory(const std::string& key);
+		std::optional<CacheEntry> LoadFromDisk(const std::string& key) const;
+
+		void Store(const CacheEntry& entry, bool write_to_disk, size_t max_memory_entries);
+
+		/**
+		 * \brief Registers a callback for the key
+		 * \return true if caller has to start the fetch, false if one is already in flight
+		 */
+		bool BeginFetch(const std::string& key, Callback callback);
+
+		/**
+		 * \brief Finishes the fetch and returns all callbacks that waited for it
+		 */
+		std::vector<Callback> EndFetch(const std::string& key);
+
+	private:
+		std::string GetFilePath(const std::string& key) const;
+
+		std::string directory_;
+
+		std::unordered_map<std::string, CacheEntry> entries_;
+		std::unordered_map<std::string, std::vector<Callback>> in_flight_;
+		std::mutex mutex_;
+	};
+} // namespace API
@@ -0,0 +1,264 @@
+#include <SpatialGrid.h>
+
+#include <cmath>
+
+#include <ActorRegistry.h>
+#include <Config.h>
+#include <IApiUtils.h>
+#include <Tools.h>
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	namespace
+	{
+		// Teams below are wild dinos
+		constexpr int min_tribe_team = 50000;
+	} // namespace
+
+	SpatialGrid::~SpatialGrid()
+	{
+		if (started_ && game_api)
+		{
+			game_api->GetCommands()->RemoveOnTickCallback("SpatialGridUpdate");
+		}
+	}
+
+	SpatialGrid& SpatialGrid::Get()
+	{
+		static SpatialGrid instance;
+		return instance;
+	}
+
+	void SpatialGrid::Start()
+	{
+		if (started_)
+		{
+			return;
+		}
+
+		started_ = true;
+
+		const float cell_size = Config::Get().GetValue<float>(Tools::GetCurrentDir() + "/config.json",
+		                                                      "/settings/SpatialGrid/CellSize", 5000.f);
+		if (cell_size > 0.f)
+		{
+			cell_size_ = cell_size;
+		}
+
+		player_class_ = AShooterCharacter::GetPrivateStaticClass();
+		dino_class_ = APrimalDinoCharacter::GetPrivateStaticClass();
+
+		// Live characters come from the actor registry instead of a world scan per tick
+		auto& registry = ActorRegistry::Get();
+		registry.Track(player_class_);
+		registry.Track(dino_class_);
+
+		game_api->GetCommands()->AddOnTickCallback("SpatialGridUpdate", std::bind(&SpatialGrid::Rebuild, this));
+
+		Rebuild();
+	}
+
+	uint64_t SpatialGrid::CellKey(float x, float y) const
+	{
+		const auto cell_x = static_cast<int32_t>(std::floor(x / cell_size_));
+		const auto cell_y = static_cast<int32_t>(std::floor(y / cell_size_));
+
+		return static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32 | static_cast<uint32_t>(cell_y);
+	}
+
+	void SpatialGrid::AddActor(AActor* actor, uint8_t kind)
+	{
+		static const DWORD64 root_offset = GetAddress(nullptr, "AActor.RootComponent");
+		static const DWORD64 transform_offset = GetAddress(nullptr, "USceneComponent.ComponentToWorld");
+
+		const auto root = Detail::ReadField<const void*>(actor, root_offset);
+		if (root == nullptr)
+		{
+			return;
+		}
+
+		const auto& transform = *reinterpret_cast<const FTransform*>(reinterpret_cast<DWORD64>(root) +
+			transform_offset);
+
+		alignas(16) float translation[4];
+		_mm_store_ps(translation, transform.Translation);
+
+		staging_xs_.push_back(translation[0]);
+		staging_ys_.push_back(translation[1]);
+		staging_zs_.push_back(translation[2]);
+		staging_actors_.push_back(actor);
+		staging_kinds_.push_back(kind);
+		staging_keys_.push_back(CellKey(translation[0], translation[1]));
+	}
+
+	void SpatialGrid::Rebuild()
+	{
+		static const DWORD64 controller_offset = GetAddress(nullptr, "APawn.Controller");
+
+		staging_xs_.clear();
+		staging_ys_.clear();
+		staging_zs_.clear();
+		staging_actors_.clear();
+		staging_kinds_.clear();
+		staging_keys_.clear();
+
+		auto& registry = ActorRegistry::Get();
+
+		// The registry resolves the actors it returns. Characters without a controller are sleeping bodies
+		// of offline players
+		for (AActor* actor : registry.GetActors(player_class_))
+		{
+			if (Detail::ReadField<const void*>(actor, controller_offset) != nullptr)
+			{
+				AddActor(actor, Players);
+			}
+		}
+
+		// Dinos are grouped by team when they register and when their team changes, so wild dinos are never read
+		teams_.clear();
+		registry.GetTeams(dino_class_, teams_);
+
+		for (const int team : teams_)
+		{
+			if (team < min_tribe_team)
+			{
+				continue;
+			}
+
+			for (AActor* actor : registry.GetTeamActors(dino_class_, team))
+			{
+				AddActor(actor, TamedDinos);
+			}
+		}
+
+		// Counting sort by cell: count, assign ranges, scatter
+		cells_.clear();
+		for (const uint64_t key : staging_keys_)
+		{
+			++cells_[key].end;
+		}
+
+		uint32_t offset = 0;
+		for (auto& [key, range] : cells_)
+		{
+			const uint32_t count = range.end;
+			range.begin = offset;
+			range.end = offset;
+			offset += count;
+		}
+
+		const size_t count = staging_keys_.size();
+		xs_.resize(count);
+		ys_.resize(count);
+		zs_.resize(count);
+		actors_.resize(count);
+		kinds_.resize(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint32_t index = cells_[staging_keys_[i]].end++;
+
+			xs_[index] = staging_xs_[i];
+			ys_[index] = staging_ys_[i];
+			zs_[index] = staging_zs_[i];
+			actors_[index] = staging_actors_[i];
+			kinds_[index] = staging_kinds_[i];
+		}
+	}
+
+	template <typename Func>
+	void SpatialGrid::ForEachCandidate(float min_x, float min_y, float max_x, float max_y, Func&& func) const
+	{
+		const double cells_x = std::floor(max_x / cell_size_) - std::floor(min_x / cell_size_) + 1;
+		const double cells_y = std::floor(max_y / cell_size_) - std::floor(min_y / cell_size_) + 1;
+
+		// Large areas cover more cells than are occupied
+		if (cells_x * cells_y > static_cast<double>(cells_.size()))
+		{
+			for (uint32_t index = 0; index < actors_.size(); ++index)
+			{
+				func(index);
+			}
+
+			return;
+		}
+
+		const auto first_x = static_cast<int32_t>(std::floor(min_x / cell_size_));
+		const auto first_y = static_cast<int32_t>(std::floor(min_y / cell_size_));
+
+		for (int32_t x = 0; x < static_cast<int32_t>(cells_x); ++x)
+		{
+			for (int32_t y = 0; y < static_cast<int32_t>(cells_y); ++y)
+			{
+				const uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(first_x + x)) << 32 |
+					static_cast<uint32_t>(first_y + y);
+
+				const auto iter = cells_.find(key);
+				if (iter == cells_.end())
+				{
+					continue;
+				}
+
+				for (uint32_t index = iter->second.begin; index < iter->second.end; ++index)
+				{
+					func(index);
+				}
+			}
+		}
+	}
+
+	size_t SpatialGrid::QueryRadius(const FVector& center, float radius, uint8_t kinds, std::vector<AActor*>& out,
+	                                const std::unordered_set<AActor*>* exclude)
+	{
+		Start();
+
+		const size_t initial_size = out.size();
+		const float radius_squared = radius * radius;
+
+		ForEachCandidate(center.X - radius, center.Y - radius, center.X + radius, center.Y + radius, [&](uint32_t index)
+		{
+			if ((kinds_[index] & kinds) == 0)
+				return;
+
+			const float dx = xs_[index] - center.X;
+			const float dy = ys_[index] - center.Y;
+			const float dz = zs_[index] - center.Z;
+			if (dx * dx + dy * dy + dz * dz > radius_squared)
+				return;
+
+			if (exclude != nullptr && exclude->count(actors_[index]) != 0)
+				return;
+
+			out.push_back(actors_[index]);
+		});
+
+		return out.size() - initial_size;
+	}
+
+	size_t SpatialGrid::QueryBox(const FVector& min, const FVector& max, uint8_t kinds, std::vector<AActor*>& out,
+	                             const std::unordered_set<AActor*>* exclude)
+	{
+		Start();
+
+		const size_t initial_size = out.size();
+
+		ForEachCandidate(min.X, min.Y, max.X, max.Y, [&](uint32_t index)
+		{
+			if ((kinds_[index] & kinds) == 0)
+				return;
+
+			if (xs_[index] < min.X || xs_[index] > max.X || ys_[index] < min.Y || ys_[index] > max.Y ||
+				zs_[index] < min.Z || zs_[index] > max.Z)
+				return;
+
+			if (exclude != nullptr && exclude->count(actors_[index]) != 0)
+				return;
+
+			out.push_back(actors_[index]);
+		});
+
+		return out.size() - initial_size;
+	}
+} // namespace API
@@ -1,6 +1,11 @@
 #include <Timer.h>
 
 #include "../IBaseApi.h"
+#include "../PluginManager/PluginStats.h"
+
+#include <intrin.h>
+
+#pragma intrinsic(_ReturnAddress)
 
 namespace API
 {
@@ -25,7 +30,8 @@ namespace API
 		const auto now = std::chrono::system_clock::now();
 		const auto exec_time = now + std::chrono::seconds(delay_seconds);
 
-		timer_funcs_.emplace_back(std::make_unique<TimerFunc>(exec_time, callback, true, 1, 0));
+		timer_funcs_.emplace_back(std::make_unique<TimerFunc>(exec_time, callback, true, 1, 0,
+		                                                      PluginStats::GetModule(_ReturnAddress())));
 	}
 
 	void Timer::RecurringExecuteInternal(const std::function<void()>& callback, int execution_interval,
@@ -55,7 +61,8 @@ namespace API
 		{
 			const auto now = std::chrono::system_clock::now();
 			timer_funcs_.emplace_back(
-				std::make_unique<TimerFunc>(now, callback, false, execution_counter, execution_interval));
+				std::make_unique<TimerFunc>(now, callback, false, execution_counter, execution_interval,
+				                            PluginStats::GetModule(_ReturnAddress())));
 		}
 	}
 
@@ -95,6 +102,7 @@ namespace API
 					data->next_time = now + std::chrono::seconds(data->execution_interval);
 				}
 
+				PluginStats::ScopedTimer timer(data->owner);
 				data->callback();
 			}
 		}
@@ -108,4 +116,15 @@ namespace API
 			}), timer_funcs_.end());
 		}
 	}
+
+	void Timer::CountTasks(std::unordered_map<HMODULE, size_t>& counts) const
+	{
+		for (const auto& data : timer_funcs_)
+		{
+			if (data != nullptr)
+			{
+				++counts[data->owner];
+			}
+		}
+	}
 } // namespace API
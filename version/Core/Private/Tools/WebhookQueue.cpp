@@ -0,0 +1,287 @@
+#include <WebhookQueue.h>
+
+#include <Requests.h>
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "json.hpp"
+
+#include "../IBaseApi.h"
+
+namespace API
+{
+	WebhookQueue::WebhookQueue()
+	{
+		game_api->GetCommands()->AddOnTickCallback("WebhookQueueUpdate", std::bind(&WebhookQueue::Update, this));
+	}
+
+	WebhookQueue::~WebhookQueue()
+	{
+		game_api->GetCommands()->RemoveOnTickCallback("WebhookQueueUpdate");
+	}
+
+	WebhookQueue& WebhookQueue::Get()
+	{
+		static WebhookQueue instance;
+		return instance;
+	}
+
+	void WebhookQueue::SetEndpointSettings(const std::string& url, const WebhookSettings& settings)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		Endpoint& endpoint = GetEndpoint(url);
+		endpoint.settings = settings;
+		endpoint.tokens = (std::min)(endpoint.tokens, static_cast<double>(settings.bucket_capacity));
+	}
+
+	void WebhookQueue::Enqueue(const std::string& url, const std::string& message)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		Endpoint& endpoint = GetEndpoint(url);
+
+		if (endpoint.pending.empty())
+		{
+			endpoint.first_pending_time = Clock::now();
+		}
+
+		endpoint.pending.push_back(message);
+		endpoint.pending_size += message.size();
+
+		while (endpoint.pending.size() > endpoint.settings.max_queued_messages)
+		{
+			endpoint.pending_size -= endpoint.pending.front().size();
+			endpoint.pending.pop_front();
+			++endpoint.dropped;
+		}
+	}
+
+	void WebhookQueue::FlushAll()
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		flush_all_ = true;
+	}
+
+	size_t WebhookQueue::GetPendingCount(const std::string& url)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		const auto iter = endpoints_.find(url);
+		return iter != endpoints_.end() ? iter->second.pending.size() + iter->second.batch.size() : 0;
+	}
+
+	size_t WebhookQueue::GetDroppedCount(const std::string& url)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		const auto iter = endpoints_.find(url);
+		return iter != endpoints_.end() ? iter->second.dropped : 0;
+	}
+
+	WebhookQueue::Endpoint& WebhookQueue::GetEndpoint(const std::string& url)
+	{
+		auto iter = endpoints_.find(url);
+		if (iter == endpoints_.end())
+		{
+			Endpoint endpoint;
+			endpoint.tokens = endpoint.settings.bucket_capacity;
+			endpoint.last_refill = Clock::now();
+
+			iter = endpoints_.emplace(url, std::move(endpoint)).first;
+		}
+
+		return iter->second;
+	}
+
+	void WebhookQueue::Update()
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		const auto now = Clock::now();
+		const bool flush_all = flush_all_;
+		flush_all_ = false;
+
+		for (auto& [url, endpoint] : endpoints_)
+		{
+			const WebhookSettings& settings = endpoint.settings;
+
+			// Refill token bucket
+			const double elapsed = std::chrono::duration<double>(now - endpoint.last_refill).count();
+			endpoint.tokens = (std::min)(static_cast<double>(settings.bucket_capacity),
+			                           endpoint.tokens + elapsed * settings.refill_per_second);
+			endpoint.last_refill = now;
+
+			if (endpoint.in_flight || now < endpoint.blocked_until)
+			{
+				continue;
+			}
+
+			if (endpoint.batch.empty() && !endpoint.pending.empty())
+			{
+				const bool window_passed = now - endpoint.first_pending_time >=
+					std::chrono::milliseconds(settings.flush_interval_ms);
+
+				if (flush_all || window_passed
+					|| endpoint.pending.size() >= settings.max_batch_messages
+					|| endpoint.pending_size >= settings.max_batch_size)
+				{
+					TakeBatch(endpoint);
+				}
+			}
+
+			if (!endpoint.batch.empty() && endpoint.tokens >= 1.0)
+			{
+				endpoint.tokens -= 1.0;
+				Send(url, endpoint);
+			}
+		}
+	}
+
+	void WebhookQueue::TakeBatch(Endpoint& endpoint)
+	{
+		size_t batch_size = 0;
+
+		while (!endpoint.pending.empty() && endpoint.batch.size() < endpoint.settings.max_batch_messages)
+		{
+			const std::string& message = endpoint.pending.front();
+
+			// Always take at least one message, even if it is bigger than the limit
+			if (!endpoint.batch.empty() && batch_size + message.size() + 1 > endpoint.settings.max_batch_size)
+			{
+				break;
+			}
+
+			batch_size += message.size() + 1;
+
+			endpoint.pending_size -= message.size();
+			endpoint.batch.push_back(std::move(endpoint.pending.front()));
+			endpoint.pending.pop_front();
+		}
+
+		endpoint.attempt = 0;
+		endpoint.first_pending_time = Clock::now();
+	}
+
+	void WebhookQueue::Send(const std::string& url, Endpoint& endpoint)
+	{
+		const WebhookSettings& settings = endpoint.settings;
+
+		const std::string body = settings.build_body
+			                         ? settings.build_body(endpoint.batch)
+			                         : BuildDefaultBody(endpoint.batch);
+
+		endpoint.in_flight = true;
+
+		Requests::Get().CreateRequest("POST", url, [this, url](bool success, Response response)
+		{
+			OnResponse(url, success, response);
+		}, body, settings.content_type, settings.headers);
+	}
+
+	void WebhookQueue::OnResponse(const std::string& url, bool success, const Response& response)
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		const auto iter = endpoints_.find(url);
+		if (iter == endpoints_.end())
+		{
+			return;
+		}
+
+		Endpoint& endpoint = iter->second;
+		const WebhookSettings& settings = endpoint.settings;
+		const auto now = Clock::now();
+
+		endpoint.in_flight = false;
+
+		// Respect bucket information sent by the remote even on success
+		if (response.GetHeader("x-ratelimit-remaining") == "0")
+		{
+			const int reset_after_ms = GetRetryAfterMs(response);
+			if (reset_after_ms > 0)
+			{
+				endpoint.blocked_until = now + std::chrono::milliseconds(reset_after_ms);
+			}
+		}
+
+		if (success)
+		{
+			endpoint.batch.clear();
+			endpoint.attempt = 0;
+			return;
+		}
+
+		const bool retryable = response.status == 0 || response.status == 429 || response.status >= 500;
+		if (!retryable || ++endpoint.attempt > settings.max_retries)
+		{
+			Log::GetLog()->warn("({}) Dropped {} messages for {} - {} {}", __FUNCTION__, endpoint.batch.size(),
+			                    url, response.status, response.reason);
+
+			endpoint.dropped += endpoint.batch.size();
+			endpoint.batch.clear();
+			endpoint.attempt = 0;
+			return;
+		}
+
+		int delay_ms = response.status == 429 ? GetRetryAfterMs(response) : 0;
+		if (delay_ms <= 0)
+		{
+			static thread_local std::mt19937 generator{std::random_device{}()};
+			std::uniform_real_distribution<double> jitter(0.5, 1.0);
+
+			const double backoff = (std::min)(static_cast<double>(settings.max_backoff_ms),
+			                                settings.base_backoff_ms * std::pow(2.0, endpoint.attempt - 1));
+			delay_ms = static_cast<int>(backoff * jitter(generator));
+		}
+
+		endpoint.blocked_until = (std::max)(endpoint.blocked_until, now + std::chrono::milliseconds(delay_ms));
+	}
+
+	std::string WebhookQueue::BuildDefaultBody(const std::vector<std::string>& messages)
+	{
+		std::string content;
+
+		for (const auto& message : messages)
+		{
+			if (!content.empty())
+				content += '\n';
+
+			content += message;
+		}
+
+		return nlohmann::json{{"content", content}}.dump();
+	}
+
+	int WebhookQueue::GetRetryAfterMs(const Response& response)
+	{
+		try
+		{
+			std::string value = response.GetHeader("retry-after");
+			if (value.empty())
+			{
+				value = response.GetHeader("x-ratelimit-reset-after");
+			}
+
+			if (!value.empty())
+			{
+				return static_cast<int>(std::stod(value) * 1000);
+			}
+
+			// Discord sends retry_after in seconds in the body
+			const auto body = nlohmann::json::parse(response.body, nullptr, false);
+			if (body.is_object() && body.contains("retry_after"))
+			{
+				return static_cast<int>(body["retry_after"].get<double>() * 1000);
+			}
+		}
+		catch (const std::exception&)
+		{
+		}
+
+		return 0;
+	}
+} // namespace API
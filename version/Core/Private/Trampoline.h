@@ -2,8 +2,13 @@
 
 #include <ITrampoline.h>
 #include <functional>
+#include <intrin.h>
 #include <map>
 
+#include "PluginManager/PluginStats.h"
+
+#pragma intrinsic(_ReturnAddress)
+
 #undef min
 #undef max
 
@@ -60,9 +65,14 @@ namespace API {
 			log_stats();
 		}
 
+		// Allocations are accounted to the plugin of the current API call, or to the API itself outside of one
 		[[nodiscard]] void* allocate(std::size_t a_size)
 		{
 			auto result = do_allocate(a_size);
+			if (result) {
+				const auto owner = PluginStats::GetCurrentOwner();
+				PluginStats::Get().AddTrampolineBytes(owner ? owner : PluginStats::GetModule(_ReturnAddress()), a_size);
+			}
 			log_stats();
 			return result;
 		}
@@ -83,6 +93,7 @@ namespace API {
 		{
 			// E9 cd
 			// JMP rel32
+			PluginStats::CallerScope caller(_ReturnAddress());
 			return write_branch<5>(a_src, a_dst, 0xE9);
 		}
 
@@ -90,6 +101,7 @@ namespace API {
 		{
 			// FF /4
 			// JMP r/m64
+			PluginStats::CallerScope caller(_ReturnAddress());
 			return write_branch<6>(a_src, a_dst, 0x25);
 		}
 
@@ -97,6 +109,7 @@ namespace API {
 		{
 			// E8 cd
 			// CALL rel32
+			PluginStats::CallerScope caller(_ReturnAddress());
 			return write_branch<5>(a_src, a_dst, 0xE8);
 		}
 
@@ -104,6 +117,7 @@ namespace API {
 		{
 			// FF /2
 			// CALL r/m64
+			PluginStats::CallerScope caller(_ReturnAddress());
 			return write_branch<6>(a_src, a_dst, 0x15);
 		}
 
@@ -10,9 +10,11 @@
 
 #include "../UE/Math/Vector.h"
 #include "../UE/Math/Rotator.h"
+#include "../UE/Math/VectorBatch.h"
 #include "../UE/NetSerialization.h"
 #include "../UE/Math/ColorList.h"
 #include "../UE/UE.h"
+#include "../UE/ObjectIterator.h"
 #include "Enums.h"
 #include "Inventory.h"
 #include "Other.h"
@@ -1635,9 +1635,11 @@ public:
 		if constexpr (!TIsCharType<T>::Value)
 			static_assert(TIsCharType<T>::Value, "format must be a char or wchar_t");
 
-		auto formatted_msg = fmt::format(format, std::forward<Args>(args)...);
+		// Formatted in the inline buffer of the writer, short messages don't allocate
+		fmt::BasicMemoryWriter<T> writer;
+		writer.write(format, std::forward<Args>(args)...);
 
-		return FString(formatted_msg.c_str());
+		return FString(writer.c_str());
 	}
 
 	
@@ -1679,6 +1681,142 @@ inline SIZE_T GetNum(const FString& String)
 	return String.GetCharArray().Num();
 }
 
+namespace API
+{
+	/**
+	 * \brief Helpers for fmt support of UE types. Text is written straight into the output buffer of fmt
+	 */
+	namespace Fmt
+	{
+		template <typename ArgFormatter, typename Char>
+		using Formatter = fmt::BasicFormatter<Char, ArgFormatter>;
+
+		/**
+		 * \brief Returns the '}' which closes the current replacement field
+		 */
+		template <typename Char>
+		const Char* FindFieldEnd(const Char* format_str)
+		{
+			while (*format_str && *format_str != '}')
+				++format_str;
+
+			if (*format_str != '}')
+				FMT_THROW(fmt::FormatError("missing '}' in format string"));
+
+			return format_str;
+		}
+
+		/**
+		 * \brief Appends UTF-16 text converted to UTF-8
+		 */
+		inline void WriteText(fmt::BasicWriter<char>& writer, const TCHAR* text, int length)
+		{
+			if (length <= 0)
+				return;
+
+			// One UTF-16 code unit takes at most 3 bytes in UTF-8
+			auto& buffer = writer.buffer();
+			const size_t offset = buffer.size();
+			buffer.resize(offset + static_cast<size_t>(length) * 3);
+
+			const int written = WideCharToMultiByte(CP_UTF8, 0, text, length, &buffer[offset], length * 3, nullptr,
+			                                        nullptr);
+			buffer.resize(offset + (written > 0 ? written : 0));
+		}
+
+		inline void WriteText(fmt::BasicWriter<wchar_t>& writer, const TCHAR* text, int length)
+		{
+			if (length > 0)
+				writer.buffer().append(text, text + length);
+		}
+
+		template <typename Char>
+		void WriteLiteral(fmt::BasicWriter<Char>& writer, const char* text)
+		{
+			for (; *text; ++text)
+				writer.buffer().push_back(static_cast<Char>(*text));
+		}
+
+		/**
+		 * \brief Formats UTF-16 text. Without a format spec the text is copied into the output buffer directly,
+		 * otherwise width, fill and precision are applied by fmt
+		 */
+		template <typename ArgFormatter, typename Char>
+		void FormatText(Formatter<ArgFormatter, Char>& f, const Char*& format_str, const TCHAR* text, int length)
+		{
+			const Char* end = FindFieldEnd(format_str);
+
+			if (*format_str == '}')
+			{
+				WriteText(f.writer(), text, length);
+			}
+			else if constexpr (std::is_same_v<Char, wchar_t>)
+			{
+				const Char* spec = format_str;
+				f.format(spec, fmt::internal::MakeArg<Formatter<ArgFormatter, Char>>(
+					         fmt::WStringRef(text, static_cast<size_t>((std::max)(length, 0)))));
+			}
+			else
+			{
+				fmt::MemoryWriter utf8;
+				WriteText(utf8, text, length);
+
+				const Char* spec = format_str;
+				f.format(spec, fmt::internal::MakeArg<Formatter<ArgFormatter, Char>>(
+					         fmt::StringRef(utf8.data(), utf8.size())));
+			}
+
+			format_str = end + 1;
+		}
+
+		/**
+		 * \brief Formats components as <label0><value0><label1><value1>...<suffix>.
+		 * The format spec is applied to every component, default_spec is used when there is none
+		 */
+		template <typename ArgFormatter, typename Char, size_t N>
+		void FormatComponents(Formatter<ArgFormatter, Char>& f, const Char*& format_str,
+		                      const char* const (&labels)[N], const float (&values)[N], const char* suffix,
+		                      const char* default_spec)
+		{
+			const Char* end = FindFieldEnd(format_str);
+
+			Char default_field[16]{':'};
+			const Char* spec = format_str;
+
+			if (*format_str == '}')
+			{
+				size_t length = 1;
+				for (; *default_spec && length < std::size(default_field) - 2; ++default_spec)
+					default_field[length++] = static_cast<Char>(*default_spec);
+
+				default_field[length] = '}';
+				spec = default_field;
+			}
+
+			for (size_t i = 0; i < N; ++i)
+			{
+				WriteLiteral(f.writer(), labels[i]);
+
+				const Char* component_spec = spec;
+				f.format(component_spec, fmt::internal::MakeArg<Formatter<ArgFormatter, Char>>(values[i]));
+			}
+
+			WriteLiteral(f.writer(), suffix);
+
+			format_str = end + 1;
+		}
+	} // namespace Fmt
+} // namespace API
+
+/**
+ * \brief Formats FString without a temporary std::string, e.g. Log::GetLog()->info("{}", name)
+ */
+template <typename ArgFormatter, typename Char>
+void format_arg(fmt::BasicFormatter<Char, ArgFormatter>& f, const Char*& format_str, const FString& value)
+{
+	API::Fmt::FormatText(f, format_str, *value, value.Len());
+}
+
 /**
 * Convert an array of bytes to a TCHAR
 * @param In byte array values to convert
@@ -366,6 +366,14 @@ FORCEINLINE FLinearColor operator*(float Scalar, const FLinearColor& Color)
 	return Color.operator*(Scalar);
 }
 
+/** Formats as (R=,G=,B=,A=), the format spec is applied to each component */
+template <typename ArgFormatter, typename Char>
+void format_arg(fmt::BasicFormatter<Char, ArgFormatter>& f, const Char*& format_str, const FLinearColor& value)
+{
+	API::Fmt::FormatComponents(f, format_str, {"(R=", ",G=", ",B=", ",A="}, {value.R, value.G, value.B, value.A}, ")",
+	                           "f");
+}
+
 //
 //	FColor
 //	Stores a color with 8 bits of precision per channel.  
@@ -584,4 +584,11 @@ FORCEINLINE bool FRotator::ContainsNaN() const
 			!FMath::IsFinite(Roll));
 }
 
+/** Formats as P= Y= R=, the format spec is applied to each component */
+template <typename ArgFormatter, typename Char>
+void format_arg(fmt::BasicFormatter<Char, ArgFormatter>& f, const Char*& format_str, const FRotator& value)
+{
+	API::Fmt::FormatComponents(f, format_str, {"P=", " Y=", " R="}, {value.Pitch, value.Yaw, value.Roll}, "", "f");
+}
+
 template<> struct TIsPODType<FRotator> { enum { Value = true }; };
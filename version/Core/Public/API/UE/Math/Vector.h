@@ -1642,6 +1642,13 @@ FORCEINLINE FString FVector::ToString() const
 	return FString(buffer);
 }
 
+/** Formats as X= Y= Z=, the format spec is applied to each component */
+template <typename ArgFormatter, typename Char>
+void format_arg(fmt::BasicFormatter<Char, ArgFormatter>& f, const Char*& format_str, const FVector& value)
+{
+	API::Fmt::FormatComponents(f, format_str, {"X=", " Y=", " Z="}, {value.X, value.Y, value.Z}, "", ".3f");
+}
+
 /** Component-wise clamp for FVector */
 FORCEINLINE FVector ClampVector(const FVector& V, const FVector& Min, const FVector& Max)
 {
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#if !defined(VECTOR_BATCH_SCALAR) && (defined(_M_X64) || defined(__SSE2__))
+#define VECTOR_BATCH_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Standalone tools, e.g. tools/VectorBatchBench, provide FVector and FORCEINLINE themselves
+#ifndef VECTOR_BATCH_STANDALONE
+#include "Vector.h"
+#endif
+
+namespace API
+{
+	/**
+	 * \brief Kernels over positions stored as separate X, Y and Z arrays. Four positions are processed per
+	 * instruction with SSE2, define VECTOR_BATCH_SCALAR to use the scalar versions only.
+	 * Results match the scalar versions exactly
+	 */
+	namespace VectorBatch
+	{
+		/**
+		 * \brief Conversion of world positions to map coordinates, see MakeMapCoordsTransform
+		 */
+		struct MapCoordsTransform
+		{
+			float lat_div;
+			float lat_offset;
+			float lon_div;
+			float lon_offset;
+		};
+
+		/**
+		 * \brief Builds the transform from world settings, zero values are replaced with the defaults of the game
+		 */
+		inline MapCoordsTransform MakeMapCoordsTransform(float lat_scale, float lon_scale, float lat_origin,
+		                                                 float lon_origin)
+		{
+			const float lat_div = 100.f / (lat_scale != 0 ? lat_scale : 800.0f);
+			const float lon_div = 100.f / (lon_scale != 0 ? lon_scale : 800.0f);
+
+			return {
+				lat_div, lat_div * std::abs(lat_origin != 0 ? lat_origin : -400000.0f),
+				lon_div, lon_div * std::abs(lon_origin != 0 ? lon_origin : -400000.0f)
+			};
+		}
+
+		namespace Scalar
+		{
+			inline void DistanceSquared(const float* xs, const float* ys, const float* zs, size_t count,
+			                            const FVector& center, float* out)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					const float dx = xs[i] - center.X;
+					const float dy = ys[i] - center.Y;
+					const float dz = zs[i] - center.Z;
+					out[i] = dx * dx + dy * dy + dz * dz;
+				}
+			}
+
+			inline size_t FilterWithinDistance(const float* xs, const float* ys, const float* zs, size_t count,
+			                                   const FVector& center, float max_distance, uint32_t* out_indices,
+			                                   size_t first = 0)
+			{
+				const float max_distance_squared = max_distance * max_distance;
+
+				size_t found = 0;
+				for (size_t i = first; i < count; ++i)
+				{
+					const float dx = xs[i] - center.X;
+					const float dy = ys[i] - center.Y;
+					const float dz = zs[i] - center.Z;
+					if (dx * dx + dy * dy + dz * dz <= max_distance_squared)
+						out_indices[found++] = static_cast<uint32_t>(i);
+				}
+
+				return found;
+			}
+
+			inline size_t FilterInBox(const float* xs, const float* ys, const float* zs, size_t count,
+			                          const FVector& min, const FVector& max, uint32_t* out_indices, size_t first = 0)
+			{
+				size_t found = 0;
+				for (size_t i = first; i < count; ++i)
+				{
+					if (xs[i] >= min.X && xs[i] <= max.X && ys[i] >= min.Y && ys[i] <= max.Y && zs[i] >= min.Z &&
+						zs[i] <= max.Z)
+						out_indices[found++] = static_cast<uint32_t>(i);
+				}
+
+				return found;
+			}
+
+			inline void ToMapCoords(const MapCoordsTransform& transform, const float* xs, const float* ys,
+			                        size_t count, float* out_x, float* out_y)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					const float lat = (transform.lat_div * ys[i] + transform.lat_offset) / 1000.f;
+					const float lon = (transform.lon_div * xs[i] + transform.lon_offset) / 1000.f;
+
+					out_x[i] = std::floor(lon * 10.0f) / 10.0f;
+					out_y[i] = std::floor(lat * 10.0f) / 10.0f;
+				}
+			}
+		} // namespace Scalar
+
+#ifdef VECTOR_BATCH_SSE2
+		namespace Detail
+		{
+			FORCEINLINE __m128 DistanceSquared4(const float* xs, const float* ys, const float* zs, size_t i,
+			                                    __m128 center_x, __m128 center_y, __m128 center_z)
+			{
+				const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), center_x);
+				const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), center_y);
+				const __m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + i), center_z);
+
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			}
+
+			FORCEINLINE size_t AppendIndices(int mask, size_t i, uint32_t* out_indices, size_t found)
+			{
+				for (; mask != 0; mask &= mask - 1)
+				{
+					unsigned long bit = 0;
+#ifdef _MSC_VER
+					_BitScanForward(&bit, static_cast<unsigned long>(mask));
+#else
+					bit = static_cast<unsigned long>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+					out_indices[found++] = static_cast<uint32_t>(i + bit);
+				}
+
+				return found;
+			}
+
+			/**
+			 * \brief floor() for values which fit into int32, SSE2 has no rounding instruction
+			 */
+			FORCEINLINE __m128 Floor(__m128 value)
+			{
+				const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+				const __m128 correction = _mm_and_ps(_mm_cmpgt_ps(truncated, value), _mm_set1_ps(1.f));
+				return _mm_sub_ps(truncated, correction);
+			}
+		} // namespace Detail
+#endif
+
+		/**
+		 * \brief Writes squared distances from center to out
+		 */
+		inline void DistanceSquared(const float* xs, const float* ys, const float* zs, size_t count,
+		                            const FVector& center, float* out)
+		{
+			size_t i = 0;
+#ifdef VECTOR_BATCH_SSE2
+			const __m128 center_x = _mm_set1_ps(center.X);
+			const __m128 center_y = _mm_set1_ps(center.Y);
+			const __m128 center_z = _mm_set1_ps(center.Z);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_ps(out + i, Detail::DistanceSquared4(xs, ys, zs, i, center_x, center_y, center_z));
+			}
+#endif
+			Scalar::DistanceSquared(xs + i, ys + i, zs + i, count - i, center, out + i);
+		}
+
+		/**
+		 * \brief Writes indices of positions within max_distance of center to out_indices
+		 * \param out_indices Must have room for count indices
+		 * \return Number of written indices
+		 */
+		inline size_t FilterWithinDistance(const float* xs, const float* ys, const float* zs, size_t count,
+		                                   const FVector& center, float max_distance, uint32_t* out_indices)
+		{
+			size_t i = 0;
+			size_t found = 0;
+#ifdef VECTOR_BATCH_SSE2
+			const __m128 center_x = _mm_set1_ps(center.X);
+			const __m128 center_y = _mm_set1_ps(center.Y);
+			const __m128 center_z = _mm_set1_ps(center.Z);
+			const __m128 max_distance_squared = _mm_set1_ps(max_distance * max_distance);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 distance = Detail::DistanceSquared4(xs, ys, zs, i, center_x, center_y, center_z);
+				const int mask = _mm_movemask_ps(_mm_cmple_ps(distance, max_distance_squared));
+				found = Detail::AppendIndices(mask, i, out_indices, found);
+			}
+#endif
+			return found + Scalar::FilterWithinDistance(xs, ys, zs, count, center, max_distance, out_indices + found,
+			                                            i);
+		}
+
+		/**
+		 * \brief Writes indices of positions inside the axis-aligned box to out_indices
+		 * \param out_indices Must have room for count indices
+		 * \return Number of written indices
+		 */
+		inline size_t FilterInBox(const float* xs, const float* ys, const float* zs, size_t count, const FVector& min,
+		                          const FVector& max, uint32_t* out_indices)
+		{
+			size_t i = 0;
+			size_t found = 0;
+#ifdef VECTOR_BATCH_SSE2
+			const __m128 min_x = _mm_set1_ps(min.X), max_x = _mm_set1_ps(max.X);
+			const __m128 min_y = _mm_set1_ps(min.Y), max_y = _mm_set1_ps(max.Y);
+			const __m128 min_z = _mm_set1_ps(min.Z), max_z = _mm_set1_ps(max.Z);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 x = _mm_loadu_ps(xs + i);
+				const __m128 y = _mm_loadu_ps(ys + i);
+				const __m128 z = _mm_loadu_ps(zs + i);
+
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(x, min_x), _mm_cmple_ps(x, max_x));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(y, min_y), _mm_cmple_ps(y, max_y)));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(z, min_z), _mm_cmple_ps(z, max_z)));
+
+				found = Detail::AppendIndices(_mm_movemask_ps(inside), i, out_indices, found);
+			}
+#endif
+			return found + Scalar::FilterInBox(xs, ys, zs, count, min, max, out_indices + found, i);
+		}
+
+		/**
+		 * \brief Finds the k positions nearest to center
+		 * \param out_indices Receives indices sorted by distance, must have room for k indices
+		 * \param out_distances_squared Receives squared distances, must have room for k values
+		 * \return Number of found positions, less than k if count < k
+		 */
+		inline size_t NearestK(const float* xs, const float* ys, const float* zs, size_t count, const FVector& center,
+		                       size_t k, uint32_t* out_indices, float* out_distances_squared)
+		{
+			size_t found = 0;
+
+			// Keeps the best k sorted, insertion is cheap because k is small compared to count
+			const auto insert = [&](size_t index, float distance)
+			{
+				if (found == k && distance >= out_distances_squared[k - 1])
+					return;
+
+				size_t position = found < k ? found++ : k - 1;
+				for (; position > 0 && out_distances_squared[position - 1] > distance; --position)
+				{
+					out_distances_squared[position] = out_distances_squared[position - 1];
+					out_indices[position] = out_indices[position - 1];
+				}
+
+				out_distances_squared[position] = distance;
+				out_indices[position] = static_cast<uint32_t>(index);
+			};
+
+			if (k == 0)
+				return 0;
+
+			size_t i = 0;
+#ifdef VECTOR_BATCH_SSE2
+			const __m128 center_x = _mm_set1_ps(center.X);
+			const __m128 center_y = _mm_set1_ps(center.Y);
+			const __m128 center_z = _mm_set1_ps(center.Z);
+
+			alignas(16) float distances[4];
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 distance = Detail::DistanceSquared4(xs, ys, zs, i, center_x, center_y, center_z);
+
+				// Skip the block if all four are farther than the current k-th
+				if (found == k && _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_set1_ps(out_distances_squared[k - 1]))) ==
+					0)
+					continue;
+
+				_mm_store_ps(distances, distance);
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					insert(i + lane, distances[lane]);
+				}
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				const float dx = xs[i] - center.X;
+				const float dy = ys[i] - center.Y;
+				const float dz = zs[i] - center.Z;
+				insert(i, dx * dx + dy * dy + dz * dz);
+			}
+
+			return found;
+		}
+
+		/**
+		 * \brief Converts world positions to map coordinates, same as ArkApi::IApiUtils::FVectorToCoords
+		 */
+		inline void ToMapCoords(const MapCoordsTransform& transform, const float* xs, const float* ys, size_t count,
+		                        float* out_x, float* out_y)
+		{
+			size_t i = 0;
+#ifdef VECTOR_BATCH_SSE2
+			const __m128 lat_div = _mm_set1_ps(transform.lat_div);
+			const __m128 lat_offset = _mm_set1_ps(transform.lat_offset);
+			const __m128 lon_div = _mm_set1_ps(transform.lon_div);
+			const __m128 lon_offset = _mm_set1_ps(transform.lon_offset);
+			const __m128 thousand = _mm_set1_ps(1000.f);
+			const __m128 ten = _mm_set1_ps(10.f);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 lat = _mm_div_ps(_mm_add_ps(_mm_mul_ps(lat_div, _mm_loadu_ps(ys + i)), lat_offset),
+				                              thousand);
+				const __m128 lon = _mm_div_ps(_mm_add_ps(_mm_mul_ps(lon_div, _mm_loadu_ps(xs + i)), lon_offset),
+				                              thousand);
+
+				_mm_storeu_ps(out_x + i, _mm_div_ps(Detail::Floor(_mm_mul_ps(lon, ten)), ten));
+				_mm_storeu_ps(out_y + i, _mm_div_ps(Detail::Floor(_mm_mul_ps(lat, ten)), ten));
+			}
+#endif
+			Scalar::ToMapCoords(transform, xs + i, ys + i, count - i, out_x + i, out_y + i);
+		}
+	} // namespace VectorBatch
+} // namespace API
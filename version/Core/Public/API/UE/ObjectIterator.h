@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Selects objects of GUObjectArray. An object matches if its class has all cast_flags and is the_class
+	 * or derives from it. Unreachable objects are always skipped, default objects and objects pending kill unless
+	 * requested
+	 */
+	struct ObjectFilter
+	{
+		UClass* the_class{nullptr};
+		ClassCastFlags cast_flags{ClassCastFlags::CASTCLASS_None};
+		bool exact_class{false};
+		bool include_pending_kill{false};
+		bool include_default_objects{false};
+	};
+
+	namespace Detail
+	{
+		// Objects are visited in ranges of this size, several ranges share a chunk of GUObjectArray
+		constexpr int objects_per_range = 8192;
+
+		/**
+		 * \brief Field offsets used by the filter, read once so the loop never looks them up by name
+		 */
+		struct ObjectLayout
+		{
+			DWORD64 object_class;
+			DWORD64 object_flags;
+			DWORD64 class_cast_flags;
+			DWORD64 super_struct;
+
+			static const ObjectLayout& Get()
+			{
+				static const ObjectLayout layout{
+					GetAddress(nullptr, "UObjectBase.Class"),
+					GetAddress(nullptr, "UObjectBase.ObjectFlags"),
+					GetAddress(nullptr, "UClass.ClassCastFlags"),
+					GetAddress(nullptr, "UStruct.SuperStruct")
+				};
+				return layout;
+			}
+		};
+
+		template <typename T>
+		FORCEINLINE T ReadField(const void* object, DWORD64 offset)
+		{
+			return *reinterpret_cast<const T*>(reinterpret_cast<DWORD64>(object) + offset);
+		}
+
+		inline FChunkedFixedUObjectArray& GetObjects()
+		{
+			static FChunkedFixedUObjectArray& objects = Globals::GUObjectArray()().ObjObjects;
+			return objects;
+		}
+
+		inline bool MatchesFilter(const ObjectLayout& layout, const ObjectFilter& filter, const UObject* object)
+		{
+			const int flags = ReadField<int>(object, layout.object_flags);
+			// Unreachable objects are about to be destroyed by the garbage collector
+			if ((flags & static_cast<int>(EObjectFlags::RF_Unreachable)) != 0)
+				return false;
+			if (!filter.include_pending_kill && (flags & static_cast<int>(EObjectFlags::RF_PendingKill)) != 0)
+				return false;
+			if (!filter.include_default_objects && (flags & static_cast<int>(EObjectFlags::RF_ClassDefaultObject)) != 0)
+				return false;
+
+			const auto object_class = ReadField<const UStruct*>(object, layout.object_class);
+			if (object_class == nullptr)
+				return false;
+
+			const auto cast_flags = static_cast<unsigned long long>(filter.cast_flags);
+			if ((ReadField<unsigned long long>(object_class, layout.class_cast_flags) & cast_flags) != cast_flags)
+				return false;
+
+			if (filter.the_class == nullptr)
+				return true;
+
+			if (filter.exact_class)
+				return object_class == reinterpret_cast<const UStruct*>(filter.the_class);
+
+			for (auto super = object_class; super != nullptr; super = ReadField<const UStruct*>(
+				     super, layout.super_struct))
+			{
+				if (super == reinterpret_cast<const UStruct*>(filter.the_class))
+					return true;
+			}
+
+			return false;
+		}
+
+		/**
+		 * \brief Visits objects in [first, last), returns false if func asked to stop
+		 */
+		template <typename Func>
+		bool VisitRange(FChunkedFixedUObjectArray& objects, const ObjectFilter& filter, int first, int last,
+		                Func& func)
+		{
+			const ObjectLayout& layout = ObjectLayout::Get();
+
+			while (first < last)
+			{
+				const int chunk = first / FChunkedFixedUObjectArray::ElementsPerChunk;
+				const int chunk_end = (std::min)((chunk + 1) * FChunkedFixedUObjectArray::ElementsPerChunk, last);
+
+				const FUObjectItem* items = objects.Objects[chunk];
+				if (items != nullptr)
+				{
+					for (int index = first; index < chunk_end; ++index)
+					{
+						UObject* object = items[index % FChunkedFixedUObjectArray::ElementsPerChunk].Object;
+						if (object == nullptr || !MatchesFilter(layout, filter, object))
+							continue;
+
+						if constexpr (std::is_same_v<std::invoke_result_t<Func&, UObject*>, bool>)
+						{
+							if (!func(object))
+								return false;
+						}
+						else
+						{
+							func(object);
+						}
+					}
+				}
+
+				first = chunk_end;
+			}
+
+			return true;
+		}
+	} // namespace Detail
+
+	/**
+	 * \brief Calls func(object) for every matching object of GUObjectArray without building an array.
+	 * Only inline field reads are used for filtering. func may return false to stop. Game thread only
+	 */
+	template <typename Func>
+	void ForEachObject(const ObjectFilter& filter, Func&& func)
+	{
+		FChunkedFixedUObjectArray& objects = Detail::GetObjects();
+		Detail::VisitRange(objects, filter, 0, objects.NumElements, func);
+	}
+
+	/**
+	 * \brief Calls func(T*) for every instance of the_class and of classes derived from it
+	 */
+	template <typename T, typename Func>
+	void ForEachObjectOfClass(UClass* the_class, Func&& func)
+	{
+		ObjectFilter filter;
+		filter.the_class = the_class;
+
+		ForEachObject(filter, [&func](UObject* object) { return func(reinterpret_cast<T*>(object)); });
+	}
+
+	/**
+	 * \brief Read-only parallel variant of ForEachObject. Ranges of the array are split across worker threads,
+	 * func(object, worker_index) is called concurrently. The calling thread works as worker 0 and returns once all
+	 * ranges are visited, so the game can't change the array meanwhile.
+	 * func may only read object fields: native calls, FString allocations and writes aren't thread-safe.
+	 * Gather results per worker_index and merge them afterwards. If func throws, the remaining ranges are skipped and
+	 * the first exception is rethrown on the calling thread once all workers are joined
+	 * \param filter Object filter
+	 * \param func Callback
+	 * \param threads Number of workers including the calling thread, 0 for the number of hardware threads
+	 * \return Number of workers used
+	 */
+	template <typename Func>
+	unsigned ParallelForEachObject(const ObjectFilter& filter, Func&& func, unsigned threads = 0)
+	{
+		FChunkedFixedUObjectArray& objects = Detail::GetObjects();
+		const int num_elements = objects.NumElements;
+		const int num_ranges = (num_elements + Detail::objects_per_range - 1) / Detail::objects_per_range;
+
+		// Resolve offsets before the workers start
+		Detail::ObjectLayout::Get();
+
+		if (threads == 0)
+			threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		threads = (std::max)((std::min)(threads, static_cast<unsigned>(num_ranges)), 1u);
+
+		std::atomic<int> next_range{0};
+
+		std::mutex exception_mutex;
+		std::exception_ptr exception;
+
+		const auto worker = [&](unsigned worker_index)
+		{
+			auto visit = [&func, worker_index](UObject* object) { func(object, worker_index); };
+
+			try
+			{
+				for (int range = next_range.fetch_add(1, std::memory_order_relaxed); range < num_ranges;
+				     range = next_range.fetch_add(1, std::memory_order_relaxed))
+				{
+					const int first = range * Detail::objects_per_range;
+					Detail::VisitRange(objects, filter, first,
+					                   (std::min)(first + Detail::objects_per_range, num_elements), visit);
+				}
+			}
+			catch (...)
+			{
+				// An exception leaving a std::thread terminates the process, keep it for the calling thread
+				next_range.store(num_ranges, std::memory_order_relaxed);
+
+				std::lock_guard<std::mutex> lock(exception_mutex);
+				if (!exception)
+					exception = std::current_exception();
+			}
+		};
+
+		// Joins the workers on every path, a thread which failed to start mustn't leave the others running
+		struct Workers
+		{
+			std::vector<std::thread> threads;
+
+			~Workers()
+			{
+				for (auto& thread : threads)
+				{
+					if (thread.joinable())
+						thread.join();
+				}
+			}
+		};
+
+		{
+			Workers workers;
+			workers.threads.reserve(threads - 1);
+			for (unsigned worker_index = 1; worker_index < threads; ++worker_index)
+			{
+				workers.threads.emplace_back(worker, worker_index);
+			}
+
+			worker(0);
+		}
+
+		if (exception)
+			std::rethrow_exception(exception);
+
+		return threads;
+	}
+} // namespace API
@@ -12,6 +12,7 @@
 #include "API/Enums.h"
 #include "API/UE/Math/Color.h"
 #include "Misc/GlobalObjectsArray.h"
+#include "../../ObjectNameIndex.h"
 
 // Base types
 
@@ -65,6 +66,16 @@ FORCEINLINE uint32 GetTypeHash(const FName& name)
 	return FCrc::MemCrc32(&name, sizeof(FName));
 }
 
+/**
+ * \brief Formats FName. The name string is resolved by the game, only the std::string copy is avoided
+ */
+template <typename ArgFormatter, typename Char>
+void format_arg(fmt::BasicFormatter<Char, ArgFormatter>& f, const Char*& format_str, const FName& value)
+{
+	const FString name = value.ToString();
+	API::Fmt::FormatText(f, format_str, *name, name.Len());
+}
+
 struct FTransform
 {
 	__m128 Rotation;
@@ -151,6 +162,12 @@ struct FWeakObjectPtr
 
 	void operator=(UObject const* __that) { return NativeCall<void, UObject const*>(this, "FWeakObjectPtr.operator=", __that); }
 	bool IsValid() { return NativeCall<bool>(this, "FWeakObjectPtr.IsValid"); }
+
+	/**
+	 * \brief Resolves a weak pointer against GUObjectArray with the same checks as the engine, without calling into it
+	 * \return Object, or nullptr if the slot was reused, the object is unreachable or it is pending kill
+	 */
+	static UObject* Resolve(int object_index, int object_serial_number, bool even_if_pending_kill);
 };
 
 template <typename T>
@@ -169,7 +186,13 @@ struct TWeakObjectPtr
 		return Get();
 	}
 
-	T* Get(bool bEvenIfPendingKill = false)
+	/**
+	 * \brief Resolves the object inline, see FWeakObjectPtr::Resolve.
+	 * Define WEAK_OBJECT_PTR_NATIVE_GET to always call the engine. Debug builds call both and compare the results
+	 */
+	T* Get(bool bEvenIfPendingKill = false);
+
+	T* GetNative(bool bEvenIfPendingKill = false)
 	{
 		return NativeCall<T*, bool>(this, "FWeakObjectPtr.Get", bEvenIfPendingKill);
 	}
@@ -677,22 +700,20 @@ struct Globals
 
 	static DataValue<FUObjectArray> GUObjectArray() { return { "Global.GUObjectArray" }; }
 
+	/**
+	 * \brief Finds a class by full name, e.g. "Class /Script/Engine.TriggerSphere", or by short name
+	 */
 	static FORCEINLINE UClass* FindClass(const std::string& name)
 	{
-		for (auto i = 0; i < Globals::GUObjectArray()().ObjObjects.NumElements; i++)
-		{
-			auto obj = Globals::GUObjectArray()().ObjObjects.GetObjectPtr(i)->Object;
-			if (obj != nullptr)
-			{
-				FString full_name;
-				obj->GetFullName(&full_name, nullptr);
-				if (name == full_name.ToString())
-				{
-					return (UClass*)obj;
-				}
-			}
-		}
-		return nullptr;
+		return API::ObjectNameIndex::Get().FindClass(name);
+	}
+
+	/**
+	 * \brief Finds an object by name, e.g. "Default__PrimalItem_WeaponRifle_C"
+	 */
+	static FORCEINLINE UObject* FindObjectByName(const std::string& name)
+	{
+		return API::ObjectNameIndex::Get().FindObjectByName(name);
 	}
 };
 
@@ -704,6 +725,54 @@ inline void Globals::GetPrivateStaticClassBody<UClass>(const wchar_t* PackageNam
 		nullptr, "Global.GetPrivateStaticClassBody<UClass>", PackageName, Name, ReturnClass, RegisterNativeFunc);
 }
 
+inline UObject* FWeakObjectPtr::Resolve(int object_index, int object_serial_number, bool even_if_pending_kill)
+{
+	static FChunkedFixedUObjectArray& objects = Globals::GUObjectArray()().ObjObjects;
+	static const DWORD64 flags_offset = GetAddress(nullptr, "UObjectBase.ObjectFlags");
+
+	if (object_serial_number == 0 || object_index < 0 || object_index >= objects.NumElements)
+		return nullptr;
+
+	const FUObjectItem* item = objects.GetObjectPtr(object_index);
+	if (item->SerialNumber != object_serial_number || item->Object == nullptr)
+		return nullptr;
+
+	// Unreachable objects are being destroyed by GC, the engine rejects them even if pending kill objects are allowed
+	const int exclusion_flags = even_if_pending_kill
+		                            ? static_cast<int>(EObjectFlags::RF_Unreachable)
+		                            : static_cast<int>(EObjectFlags::RF_Unreachable) | static_cast<int>(
+			                            EObjectFlags::RF_PendingKill);
+
+	const auto flags = *reinterpret_cast<const int*>(reinterpret_cast<DWORD64>(item->Object) + flags_offset);
+	if ((flags & exclusion_flags) != 0)
+		return nullptr;
+
+	return item->Object;
+}
+
+template <typename T>
+T* TWeakObjectPtr<T>::Get(bool bEvenIfPendingKill)
+{
+#ifdef WEAK_OBJECT_PTR_NATIVE_GET
+	return GetNative(bEvenIfPendingKill);
+#else
+	T* object = reinterpret_cast<T*>(FWeakObjectPtr::Resolve(ObjectIndex, ObjectSerialNumber, bEvenIfPendingKill));
+
+#ifdef _DEBUG
+	T* native_object = GetNative(bEvenIfPendingKill);
+	if (object != native_object)
+	{
+		LOG_RATE_LIMITED(spdlog::level::err, 10000,
+		                 "TWeakObjectPtr::Get mismatch (index {}, serial {}): inline {}, engine {}", ObjectIndex,
+		                 ObjectSerialNumber, static_cast<const void*>(object), static_cast<const void*>(native_object));
+		return native_object;
+	}
+#endif
+
+	return object;
+#endif
+}
+
 struct FAssetData
 {
 	FName ObjectPath;
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+
+struct AActor;
+struct UClass;
+
+namespace API
+{
+	/**
+	 * \brief Opt-in registry of live actors of tracked classes, maintained from the AActor BeginPlay and Destroyed hooks.
+	 * Actors of a tracked class and of classes derived from it are kept in dense arrays, grouped by targeting team,
+	 * so counting or listing actors of a tribe doesn't need a world scan.
+	 * Actors freed by GC without Destroyed, e.g. by level streaming, are dropped when their weak reference
+	 * no longer resolves, so only live actors are handed out.
+	 * Classes are tracked by plugins with Track() or listed in settings/ActorRegistry/Classes of config.json.
+	 * Must be used from the game thread
+	 */
+	class ActorRegistry
+	{
+	public:
+		ARK_API static ActorRegistry& Get();
+
+		ActorRegistry(const ActorRegistry&) = delete;
+		ActorRegistry(ActorRegistry&&) = delete;
+		ActorRegistry& operator=(const ActorRegistry&) = delete;
+		ActorRegistry& operator=(ActorRegistry&&) = delete;
+
+		/**
+		 * \brief Starts tracking the class. Actors which already exist are added immediately
+		 * \return true if the class wasn't tracked before
+		 */
+		ARK_API bool Track(UClass* the_class);
+
+		/**
+		 * \brief Starts tracking the class found by Globals::FindClass, e.g. "PrimalDinoCharacter"
+		 * \return true if the class was found and wasn't tracked before
+		 */
+		ARK_API bool Track(const std::string& class_name);
+
+		ARK_API bool IsTracked(UClass* the_class) const;
+
+		/**
+		 * \brief Returns live actors of the tracked class. Empty if the class isn't tracked.
+		 * The array is invalidated by the next spawn, destroy or lookup
+		 */
+		ARK_API const std::vector<AActor*>& GetActors(UClass* the_class);
+
+		/**
+		 * \brief Returns live actors of the tracked class which belong to the team, e.g. tamed dinos of a tribe
+		 */
+		ARK_API const std::vector<AActor*>& GetTeamActors(UClass* the_class, int team);
+
+		ARK_API size_t GetTeamCount(UClass* the_class, int team);
+
+		/**
+		 * \brief Appends teams which have actors of the tracked class to out, e.g. to visit tamed dinos
+		 * without touching wild ones
+		 */
+		ARK_API void GetTeams(UClass* the_class, std::vector<int>& out) const;
+
+		/**
+		 * \brief Tracks classes listed in config.json. Called by the API when the server is ready
+		 */
+		void OnServerReady();
+
+		void OnBeginPlay(AActor* actor);
+		void OnDestroyed(AActor* actor);
+
+	private:
+		struct Entry
+		{
+			int team;
+			// Index in Family::teams[team]
+			uint32_t team_slot;
+
+			// Weak reference to the actor, the address can be reused after GC
+			int object_index;
+			int serial_number;
+		};
+
+		struct Family
+		{
+			UClass* the_class;
+			std::vector<AActor*> actors;
+			// Parallel to actors
+			std::vector<Entry> entries;
+			std::unordered_map<int, std::vector<AActor*>> teams;
+			size_t refresh_cursor{0};
+		};
+
+		struct Location
+		{
+			uint32_t family;
+			uint32_t slot;
+		};
+
+		ActorRegistry() = default;
+		~ActorRegistry();
+
+		const Family* FindFamily(UClass* the_class) const;
+		int FindFamilyIndex(UClass* the_class) const;
+		bool IsInstanceOf(AActor* actor, UClass* the_class) const;
+
+		void Add(uint32_t family_index, AActor* actor);
+		void Remove(uint32_t family_index, uint32_t slot);
+		void SetTeam(Family& family, uint32_t slot, int team);
+		Location* FindLocation(AActor* actor, uint32_t family_index);
+
+		bool IsLive(const Family& family, uint32_t slot) const;
+
+		/**
+		 * \brief Drops actors of the family which no longer resolve, or only those of the team if it isn't nullptr
+		 */
+		void RemoveStale(uint32_t family_index, const int* team);
+
+		/**
+		 * \brief Picks up team changes, e.g. taming, and drops actors which were killed or freed without Destroyed
+		 */
+		void Update();
+
+		std::vector<Family> families_;
+		std::unordered_multimap<AActor*, Location> locations_;
+		bool tick_registered_{false};
+	};
+} // namespace API
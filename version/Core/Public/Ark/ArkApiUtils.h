@@ -1,9 +1,14 @@
 #pragma once
 
+#include <functional>
 #include <optional>
+#include <unordered_set>
+#include <vector>
 
 #include <API/ARK/Ark.h>
 #include <../Private/Ark/Globals.h>
+#include <BlueprintCache.h>
+#include <InventoryIndex.h>
 
 namespace ArkApi
 {
@@ -15,6 +20,95 @@ namespace ArkApi
 		float y = 0.f;
 	};
 
+	/**
+	 * \brief Recipients of a broadcast, resolved against the online player index when the broadcast is sent
+	 */
+	struct BroadcastAudience
+	{
+		enum class Type
+		{
+			All,
+			Tribe,
+			Radius,
+			Admins,
+			SteamIds,
+			Predicate
+		};
+
+		static BroadcastAudience All()
+		{
+			return {};
+		}
+
+		static BroadcastAudience Tribe(int tribe_id)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Tribe;
+			audience.tribe_id = tribe_id;
+			return audience;
+		}
+
+		static BroadcastAudience Radius(const FVector& location, float radius)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Radius;
+			audience.location = location;
+			audience.radius = radius;
+			return audience;
+		}
+
+		static BroadcastAudience Admins()
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Admins;
+			return audience;
+		}
+
+		static BroadcastAudience SteamIds(std::vector<uint64> steam_ids)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::SteamIds;
+			audience.steam_ids = std::move(steam_ids);
+			return audience;
+		}
+
+		static BroadcastAudience Predicate(std::function<bool(AShooterPlayerController*)> predicate)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Predicate;
+			audience.predicate = std::move(predicate);
+			return audience;
+		}
+
+		Type type{Type::All};
+		int tribe_id{0};
+		FVector location{0, 0, 0};
+		float radius{0};
+		std::vector<uint64> steam_ids;
+		std::function<bool(AShooterPlayerController*)> predicate;
+	};
+
+	/**
+	 * \brief Message of a broadcast. Built once and sent as is to every recipient
+	 */
+	struct BroadcastMessage
+	{
+		enum class Type
+		{
+			ServerMessage,
+			Notification,
+			Chat
+		};
+
+		Type type{Type::ServerMessage};
+		FString text;
+		FLinearColor color;
+		float display_scale{1};
+		float display_time{0};
+		UTexture2D* icon{nullptr};
+		FChatMessage chat_message;
+	};
+
 	class ARK_API IApiUtils
 	{
 	public:
@@ -121,17 +215,7 @@ namespace ArkApi
 		FORCEINLINE void SendServerMessageToAll(FLinearColor msg_color, const T* msg,
 			Args&&... args)
 		{
-			FString text(FString::Format(msg, std::forward<Args>(args)...));
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->ClientServerChatDirectMessage(&text, msg_color, false);
-				}
-			}
+			BroadcastServerMessage(BroadcastAudience::All(), 0, msg_color, msg, std::forward<Args>(args)...);
 		}
 
 		/**
@@ -149,18 +233,8 @@ namespace ArkApi
 		FORCEINLINE void SendNotificationToAll(FLinearColor color, float display_scale,
 			float display_time, UTexture2D* icon, const T* msg, Args&&... args)
 		{
-			FString text(FString::Format(msg, std::forward<Args>(args)...));
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->
-						ClientServerSOTFNotificationCustom(&text, color, display_scale, display_time, icon, nullptr);
-				}
-			}
+			BroadcastNotification(BroadcastAudience::All(), 0, color, display_scale, display_time, icon, msg,
+			                      std::forward<Args>(args)...);
 		}
 
 		/**
@@ -174,21 +248,87 @@ namespace ArkApi
 		template <typename T, typename... Args>
 		FORCEINLINE void SendChatMessageToAll(const FString& sender_name, const T* msg, Args&&... args)
 		{
-			const FString text(FString::Format(msg, std::forward<Args>(args)...));
+			BroadcastChatMessage(BroadcastAudience::All(), 0, sender_name, msg, std::forward<Args>(args)...);
+		}
+
+		/**
+		 * \brief Returns online players of the audience
+		 */
+		FORCEINLINE TArray<AShooterPlayerController*> GetAudience(const BroadcastAudience& audience) const
+		{
+			return GetAudience_Internal(audience);
+		}
 
-			FChatMessage chat_message = FChatMessage();
-			chat_message.SenderName = sender_name;
-			chat_message.Message = text;
+		/**
+		 * \brief Sends server message to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, large broadcasts are spread over several frames. 0 sends to all at once
+		 * \param msg_color Message color
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		FORCEINLINE void BroadcastServerMessage(const BroadcastAudience& audience, size_t batch_size, FLinearColor msg_color,
+			const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::ServerMessage;
+			message.text = FString::Format(msg, std::forward<Args>(args)...);
+			message.color = msg_color;
 
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->ClientChatMessage(chat_message);
-				}
-			}
+			Broadcast_Internal(audience, std::move(message), batch_size);
+		}
+
+		/**
+		 * \brief Sends notification (on-screen message) to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, 0 sends to all at once
+		 * \param color Message color
+		 * \param display_scale Size of text
+		 * \param display_time Display time
+		 * \param icon Message icon (optional)
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		FORCEINLINE void BroadcastNotification(const BroadcastAudience& audience, size_t batch_size, FLinearColor color,
+			float display_scale, float display_time, UTexture2D* icon, const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::Notification;
+			message.text = FString::Format(msg, std::forward<Args>(args)...);
+			message.color = color;
+			message.display_scale = display_scale;
+			message.display_time = display_time;
+			message.icon = icon;
+
+			Broadcast_Internal(audience, std::move(message), batch_size);
+		}
+
+		/**
+		 * \brief Sends chat message to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, 0 sends to all at once
+		 * \param sender_name Name of the sender
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		FORCEINLINE void BroadcastChatMessage(const BroadcastAudience& audience, size_t batch_size, const FString& sender_name,
+			const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::Chat;
+			message.chat_message.SenderName = sender_name;
+			message.chat_message.Message = FString::Format(msg, std::forward<Args>(args)...);
+
+			Broadcast_Internal(audience, std::move(message), batch_size);
 		}
 
 		/**
@@ -208,28 +348,13 @@ namespace ArkApi
 		}
 
 		/**
-		 * \brief Finds player from the given steam name
+		 * \brief Finds online player from the given steam name, case-insensitive
 		 * \param steam_name Steam name
 		 * \return Pointer to AShooterPlayerController
 		 */
 		FORCEINLINE AShooterPlayerController* FindPlayerFromSteamName(const FString& steam_name) const
 		{
-			AShooterPlayerController* result = nullptr;
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				const FString current_name = player_controller->PlayerStateField()->PlayerNameField();
-				if (current_name == steam_name)
-				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-
-					result = shooter_pc;
-					break;
-				}
-			}
-
-			return result;
+			return FindPlayerFromSteamName_Internal(steam_name);
 		}
 
 		/**
@@ -254,7 +379,7 @@ namespace ArkApi
 		}
 
 		/**
-		* \brief Finds all matching players from the given character name
+		* \brief Finds all matching online players from the given character name
 		* \param character_name Character name
 		* \param search Type Defaulted To ESearchCase::Type::IgnoreCase
 		* \param full_match Will match the full length of the string if true
@@ -264,23 +389,7 @@ namespace ArkApi
 			ESearchCase::Type search,
 			bool full_match) const
 		{
-			TArray<AShooterPlayerController*> found_players;
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				auto* shooter_player = static_cast<AShooterPlayerController*>(player_controller.Get());
-				FString char_name = GetCharacterName(shooter_player);
-
-				if (!char_name.IsEmpty() && (full_match
-					? char_name.Equals(character_name, search)
-					: char_name.StartsWith(character_name, search)))
-				{
-					found_players.Add(shooter_player);
-				}
-			}
-
-			return found_players;
+			return FindPlayerFromCharacterName_Internal(character_name, search, full_match);
 		}
 
 		/**
@@ -318,6 +427,26 @@ namespace ArkApi
 			return FindPlayerFromSteamId_Internal(steam_id);
 		}
 
+		/**
+		 * \brief Finds online player from the given player data id
+		 * \param player_id Player data id
+		 * \return Pointer to AShooterPlayerController
+		 */
+		FORCEINLINE AShooterPlayerController* FindPlayerFromPlayerId(uint64 player_id) const
+		{
+			return FindPlayerFromPlayerId_Internal(player_id);
+		}
+
+		/**
+		 * \brief Finds all online players of the given tribe
+		 * \param tribe_id Tribe id (targeting team)
+		 * \return Array of AShooterPlayerController*
+		 */
+		FORCEINLINE TArray<AShooterPlayerController*> FindPlayersFromTribeId(int tribe_id) const
+		{
+			return FindPlayersFromTribeId_Internal(tribe_id);
+		}
+
 		/**
 		 * \brief Spawns an item drop
 		 * \param blueprint Item simplified BP
@@ -338,8 +467,7 @@ namespace ArkApi
 				return false;
 			}
 
-			UObject* object = Globals::
-				StaticLoadObject(UObject::StaticClass(), nullptr, blueprint, nullptr, 0, 0, true);
+			UObject* object = API::BlueprintCache::Get().LoadObject(blueprint);
 			if (!object)
 			{
 				return false;
@@ -558,6 +686,34 @@ namespace ArkApi
 			return item_count;
 		}
 
+		/**
+		 * \brief Counts a specific items quantity using the inventory index of the player
+		 * \param player_controller Player
+		 * \param item_class Class of the item you want to count the quantity of
+		 * \return On success, the function returns amount of items player has. Returns -1 if the function has failed.
+		 */
+		static FORCEINLINE int GetInventoryItemCount(AShooterPlayerController* player_controller, UClass* item_class)
+		{
+			if (player_controller == nullptr)
+			{
+				return -1;
+			}
+
+			AShooterCharacter* character = player_controller->GetPlayerCharacter();
+			if (character == nullptr)
+			{
+				return -1;
+			}
+
+			UPrimalInventoryComponent* inventory_component = character->MyInventoryComponentField();
+			if (inventory_component == nullptr)
+			{
+				return -1;
+			}
+
+			return API::InventoryIndex::Get().GetItemCount(inventory_component, item_class);
+		}
+
 		/**
 		 * \brief Returns IP address of player
 		 */
@@ -603,21 +759,10 @@ namespace ArkApi
 
 		FORCEINLINE uint64 GetSteamIDForPlayerID(int player_id) const
 		{
-			uint64 steam_id = GetShooterGameMode()->GetSteamIDForPlayerID(player_id);
+			uint64 steam_id = GetSteamIDForPlayerID_Internal(player_id);
 			if (steam_id == 0)
 			{
-				const auto& player_controllers = GetWorld()->PlayerControllerListField();
-				for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-					if (shooter_pc != nullptr && shooter_pc->LinkedPlayerIDField() == player_id)
-					{
-						steam_id = shooter_pc->GetUniqueNetIdAsUINT64();
-						break;
-					}
-				}
-
-				GetShooterGameMode()->AddPlayerID(player_id, steam_id);
+				steam_id = GetShooterGameMode()->GetSteamIDForPlayerID(player_id);
 			}
 
 			return steam_id;
@@ -637,18 +782,16 @@ namespace ArkApi
 		}
 
 		/**
-		 * \brief Returns blueprint path from any UClass
+		 * \brief Returns blueprint path from any UClass. The path is built once per class and cached
 		 */
 		static FORCEINLINE FString GetClassBlueprint(UClass* the_class)
 		{
-			if (the_class != nullptr)
+			return API::BlueprintCache::Get().GetClassBlueprint(the_class, [](UClass* blueprint_class)
 			{
 				FString path;
-				UVictoryCore::ClassToStringReference(&path, TSubclassOf<UObject>(the_class));
+				UVictoryCore::ClassToStringReference(&path, TSubclassOf<UObject>(blueprint_class));
 				return "Blueprint'" + path.LeftChop(2) + "'";
-			}
-
-			return FString("");
+			});
 		}
 
 		/**
@@ -730,45 +873,55 @@ namespace ArkApi
 		/**
 		* \brief Gets all actors in radius at location, with ignore actors
 		*/
-		FORCEINLINE TArray<AActor*> GetAllActorsInRange(FVector location, float radius, EServerOctreeGroup::Type ActorType, TArray<AActor*> ignores)
+		FORCEINLINE TArray<AActor*> GetAllActorsInRange(FVector location, float radius, EServerOctreeGroup::Type ActorType, const TArray<AActor*>& ignores)
 		{
 			TArray<AActor*> out_actors;
 
 			UVictoryCore::ServerOctreeOverlapActors(&out_actors, GetWorld(), location, radius, ActorType, true);
 
-			for (AActor* ignore : ignores)
-				out_actors.Remove(ignore);
+			if (ignores.Num() > 0)
+			{
+				const std::unordered_set<AActor*> ignored(ignores.GetData(), ignores.GetData() + ignores.Num());
+				out_actors.RemoveAll([&ignored](AActor* actor) { return ignored.count(actor) != 0; });
+			}
 
 			return out_actors;
 		}
 
 		/**
-		* \brief Converts FVector into coords that are displayed when you view the ingame map
+		* \brief Returns the conversion of world positions to map coordinates for the current map.
+		* Keep the result to convert many positions without reading world settings each time
 		*/
-		FORCEINLINE MapCoords FVectorToCoords(FVector actor_position)
+		FORCEINLINE API::VectorBatch::MapCoordsTransform GetMapCoordsTransform()
 		{
 			AWorldSettings* world_settings = GetWorld()->GetWorldSettings(false, true);
 			APrimalWorldSettings* p_world_settings = static_cast<APrimalWorldSettings*>(world_settings);
-			MapCoords coords;
-
-			float lat_scale = p_world_settings->LatitudeScaleField() != 0 ? p_world_settings->LatitudeScaleField() : 800.0f;
-			float lon_scale = p_world_settings->LongitudeScaleField() != 0 ? p_world_settings->LongitudeScaleField() : 800.0f;
 
-			float lat_origin = p_world_settings->LatitudeOriginField() != 0 ? p_world_settings->LatitudeOriginField() : -400000.0f;
-			float lon_origin = p_world_settings->LongitudeOriginField() != 0 ? p_world_settings->LongitudeOriginField() : -400000.0f;
-
-			float lat_div = 100.f / lat_scale;
-			float lat = (lat_div * actor_position.Y + lat_div * abs(lat_origin)) / 1000.f;
-
-			float lon_div = 100.f / lon_scale;
-			float lon = (lon_div * actor_position.X + lon_div * abs(lon_origin)) / 1000.f;
+			return API::VectorBatch::MakeMapCoordsTransform(p_world_settings->LatitudeScaleField(),
+				p_world_settings->LongitudeScaleField(), p_world_settings->LatitudeOriginField(),
+				p_world_settings->LongitudeOriginField());
+		}
 
-			coords.x = std::floor(lon * 10.0f) / 10.0f;
-			coords.y = std::floor(lat * 10.0f) / 10.0f;
+		/**
+		* \brief Converts FVector into coords that are displayed when you view the ingame map
+		*/
+		FORCEINLINE MapCoords FVectorToCoords(FVector actor_position)
+		{
+			MapCoords coords;
+			API::VectorBatch::Scalar::ToMapCoords(GetMapCoordsTransform(), &actor_position.X, &actor_position.Y, 1,
+				&coords.x, &coords.y);
 
 			return coords;
 		}
 
+		/**
+		* \brief Converts positions given as separate X and Y arrays into map coords, world settings are read once
+		*/
+		FORCEINLINE void FVectorToCoords(const float* xs, const float* ys, size_t count, float* out_x, float* out_y)
+		{
+			API::VectorBatch::ToMapCoords(GetMapCoordsTransform(), xs, ys, count, out_x, out_y);
+		}
+
 		/**
 		* \brief obtains the steam ID of an attacker, meant to be used in hooks such as TakeDamage
 		* \param tribe_check if set to true will return NULL if the target is from the same tribe as the attacker
@@ -802,6 +955,15 @@ namespace ArkApi
 		}
 	private:
 		virtual AShooterPlayerController* FindPlayerFromSteamId_Internal(uint64 steam_id) const = 0;
+		virtual AShooterPlayerController* FindPlayerFromSteamName_Internal(const FString& steam_name) const = 0;
+		virtual AShooterPlayerController* FindPlayerFromPlayerId_Internal(uint64 player_id) const = 0;
+		virtual TArray<AShooterPlayerController*> FindPlayerFromCharacterName_Internal(const FString& character_name,
+		                                                                              ESearchCase::Type search,
+		                                                                              bool full_match) const = 0;
+		virtual TArray<AShooterPlayerController*> FindPlayersFromTribeId_Internal(int tribe_id) const = 0;
+		virtual uint64 GetSteamIDForPlayerID_Internal(uint64 player_id) const = 0;
+		virtual TArray<AShooterPlayerController*> GetAudience_Internal(const BroadcastAudience& audience) const = 0;
+		virtual void Broadcast_Internal(const BroadcastAudience& audience, BroadcastMessage message, size_t batch_size) = 0;
 	};
 
 	ARK_API IApiUtils& APIENTRY GetApiUtils();
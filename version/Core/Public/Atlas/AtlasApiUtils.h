@@ -1,13 +1,107 @@
 #pragma once
 
+#include <functional>
 #include <optional>
+#include <unordered_set>
+#include <vector>
 
 #include <API/Atlas/Atlas.h>
+#include <BlueprintCache.h>
+#include <InventoryIndex.h>
 
 namespace ArkApi
 {
 	enum class ServerStatus { Loading, Ready };
 
+	/**
+	 * \brief Recipients of a broadcast, resolved against the online player index when the broadcast is sent
+	 */
+	struct BroadcastAudience
+	{
+		enum class Type
+		{
+			All,
+			Tribe,
+			Radius,
+			Admins,
+			SteamIds,
+			Predicate
+		};
+
+		static BroadcastAudience All()
+		{
+			return {};
+		}
+
+		static BroadcastAudience Tribe(int tribe_id)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Tribe;
+			audience.tribe_id = tribe_id;
+			return audience;
+		}
+
+		static BroadcastAudience Radius(const FVector& location, float radius)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Radius;
+			audience.location = location;
+			audience.radius = radius;
+			return audience;
+		}
+
+		static BroadcastAudience Admins()
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Admins;
+			return audience;
+		}
+
+		static BroadcastAudience SteamIds(std::vector<uint64> steam_ids)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::SteamIds;
+			audience.steam_ids = std::move(steam_ids);
+			return audience;
+		}
+
+		static BroadcastAudience Predicate(std::function<bool(AShooterPlayerController*)> predicate)
+		{
+			BroadcastAudience audience;
+			audience.type = Type::Predicate;
+			audience.predicate = std::move(predicate);
+			return audience;
+		}
+
+		Type type{Type::All};
+		int tribe_id{0};
+		FVector location{0, 0, 0};
+		float radius{0};
+		std::vector<uint64> steam_ids;
+		std::function<bool(AShooterPlayerController*)> predicate;
+	};
+
+	/**
+	 * \brief Message of a broadcast. Built once and sent as is to every recipient
+	 */
+	struct BroadcastMessage
+	{
+		enum class Type
+		{
+			ServerMessage,
+			Notification,
+			Chat
+		};
+
+		Type type{Type::ServerMessage};
+		FString text;
+		FLinearColor color;
+		float display_scale{1};
+		float display_time{0};
+		UTexture2D* icon{nullptr};
+		FChatMessage chat_message;
+	};
+
 	class ARK_API IApiUtils
 	{
 	public:
@@ -114,17 +208,7 @@ namespace ArkApi
 		void SendServerMessageToAll(FLinearColor msg_color, const T* msg,
 			Args&&... args)
 		{
-			FString text(FString::Format(msg, std::forward<Args>(args)...));
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->ClientServerChatDirectMessage(&text, msg_color, false);
-				}
-			}
+			BroadcastServerMessage(BroadcastAudience::All(), 0, msg_color, msg, std::forward<Args>(args)...);
 		}
 
 		/**
@@ -142,18 +226,8 @@ namespace ArkApi
 		void SendNotificationToAll(FLinearColor color, float display_scale,
 			float display_time, UTexture2D* icon, const T* msg, Args&&... args)
 		{
-			FString text(FString::Format(msg, std::forward<Args>(args)...));
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->
-						ClientServerSOTFNotificationCustom(&text, color, display_scale, display_time, icon, nullptr);
-				}
-			}
+			BroadcastNotification(BroadcastAudience::All(), 0, color, display_scale, display_time, icon, msg,
+			                      std::forward<Args>(args)...);
 		}
 
 		/**
@@ -167,21 +241,87 @@ namespace ArkApi
 		template <typename T, typename... Args>
 		void SendChatMessageToAll(const FString& sender_name, const T* msg, Args&&... args)
 		{
-			const FString text(FString::Format(msg, std::forward<Args>(args)...));
+			BroadcastChatMessage(BroadcastAudience::All(), 0, sender_name, msg, std::forward<Args>(args)...);
+		}
 
-			FChatMessage chat_message = FChatMessage();
-			chat_message.SenderName = sender_name;
-			chat_message.Message = text;
+		/**
+		 * \brief Returns online players of the audience
+		 */
+		TArray<AShooterPlayerController*> GetAudience(const BroadcastAudience& audience) const
+		{
+			return GetAudience_Internal(audience);
+		}
 
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-				if (shooter_pc)
-				{
-					shooter_pc->ClientChatMessage(chat_message);
-				}
-			}
+		/**
+		 * \brief Sends server message to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, large broadcasts are spread over several frames. 0 sends to all at once
+		 * \param msg_color Message color
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		void BroadcastServerMessage(const BroadcastAudience& audience, size_t batch_size, FLinearColor msg_color,
+			const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::ServerMessage;
+			message.text = FString::Format(msg, std::forward<Args>(args)...);
+			message.color = msg_color;
+
+			Broadcast_Internal(audience, std::move(message), batch_size);
+		}
+
+		/**
+		 * \brief Sends notification (on-screen message) to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, 0 sends to all at once
+		 * \param color Message color
+		 * \param display_scale Size of text
+		 * \param display_time Display time
+		 * \param icon Message icon (optional)
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		void BroadcastNotification(const BroadcastAudience& audience, size_t batch_size, FLinearColor color,
+			float display_scale, float display_time, UTexture2D* icon, const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::Notification;
+			message.text = FString::Format(msg, std::forward<Args>(args)...);
+			message.color = color;
+			message.display_scale = display_scale;
+			message.display_time = display_time;
+			message.icon = icon;
+
+			Broadcast_Internal(audience, std::move(message), batch_size);
+		}
+
+		/**
+		 * \brief Sends chat message to the audience. Using fmt::format.
+		 * \tparam T Either a a char or wchar_t
+		 * \tparam Args Optional arguments types
+		 * \param audience Recipients
+		 * \param batch_size Recipients per frame, 0 sends to all at once
+		 * \param sender_name Name of the sender
+		 * \param msg Message
+		 * \param args Optional arguments
+		 */
+		template <typename T, typename... Args>
+		void BroadcastChatMessage(const BroadcastAudience& audience, size_t batch_size, const FString& sender_name,
+			const T* msg, Args&&... args)
+		{
+			BroadcastMessage message;
+			message.type = BroadcastMessage::Type::Chat;
+			message.chat_message.SenderName = sender_name;
+			message.chat_message.Message = FString::Format(msg, std::forward<Args>(args)...);
+
+			Broadcast_Internal(audience, std::move(message), batch_size);
 		}
 
 		/**
@@ -216,28 +356,13 @@ namespace ArkApi
 		}
 
 		/**
-		 * \brief Finds player from the given steam name
+		 * \brief Finds online player from the given steam name, case-insensitive
 		 * \param steam_name Steam name
 		 * \return Pointer to AShooterPlayerController
 		 */
 		AShooterPlayerController* FindPlayerFromSteamName(const FString& steam_name) const
 		{
-			AShooterPlayerController* result = nullptr;
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				const FString current_name = player_controller->PlayerStateField()->PlayerNameField();
-				if (current_name == steam_name)
-				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-
-					result = shooter_pc;
-					break;
-				}
-			}
-
-			return result;
+			return FindPlayerFromSteamName_Internal(steam_name);
 		}
 
 		/**
@@ -265,7 +390,7 @@ namespace ArkApi
 		}
 
 		/**
-		* \brief Finds all matching players from the given character name
+		* \brief Finds all matching online players from the given character name
 		* \param character_name Character name
 		* \param search Type Defaulted To ESearchCase::Type::IgnoreCase
 		* \param full_match Will match the full length of the string if true
@@ -275,23 +400,7 @@ namespace ArkApi
 			ESearchCase::Type search,
 			bool full_match) const
 		{
-			TArray<AShooterPlayerController*> found_players;
-
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				auto* shooter_player = static_cast<AShooterPlayerController*>(player_controller.Get());
-				FString char_name = GetCharacterName(shooter_player);
-
-				if (!char_name.IsEmpty() && (full_match
-					? char_name.Equals(character_name, search)
-					: char_name.StartsWith(character_name, search)))
-				{
-					found_players.Add(shooter_player);
-				}
-			}
-
-			return found_players;
+			return FindPlayerFromCharacterName_Internal(character_name, search, full_match);
 		}
 
 		/**
@@ -343,10 +452,30 @@ namespace ArkApi
 			return FindPlayerFromSteamId_Internal(steam_id);
 		}
 
+		/**
+		 * \brief Finds online player from the given player data id
+		 * \param player_id Player data id
+		 * \return Pointer to AShooterPlayerController
+		 */
+		AShooterPlayerController* FindPlayerFromPlayerId(uint64 player_id) const
+		{
+			return FindPlayerFromPlayerId_Internal(player_id);
+		}
+
+		/**
+		 * \brief Finds all online players of the given tribe
+		 * \param tribe_id Tribe id (targeting team)
+		 * \return Array of AShooterPlayerController*
+		 */
+		TArray<AShooterPlayerController*> FindPlayersFromTribeId(int tribe_id) const
+		{
+			return FindPlayersFromTribeId_Internal(tribe_id);
+		}
+
 		/*bool SpawnDrop(const wchar_t* blueprint, FVector pos, int amount, float item_quality = 0.0f,
 					   bool force_blueprint = false, float life_span = 0.0f) const
 		{
-			UObject* object = Globals::StaticLoadObject(UObject::StaticClass(), nullptr, blueprint, nullptr, 0, 0, true);
+			UObject* object = API::BlueprintCache::Get().LoadObject(blueprint);
 			TSubclassOf<UPrimalItem> archetype;// (reinterpret_cast<UClass*>(object));
 			archetype.uClass = reinterpret_cast<UClass*>(object);
 			TSubclassOf<ADroppedItem> archetype_dropped;
@@ -553,6 +682,34 @@ namespace ArkApi
 			return item_count;
 		}
 
+		/**
+		 * \brief Counts a specific items quantity using the inventory index of the player
+		 * \param player_controller Player
+		 * \param item_class Class of the item you want to count the quantity of
+		 * \return On success, the function returns amount of items player has. Returns -1 if the function has failed.
+		 */
+		static int GetInventoryItemCount(AShooterPlayerController* player_controller, UClass* item_class)
+		{
+			if (player_controller == nullptr)
+			{
+				return -1;
+			}
+
+			AShooterCharacter* character = player_controller->GetPlayerCharacter();
+			if (character == nullptr)
+			{
+				return -1;
+			}
+
+			UPrimalInventoryComponent* inventory_component = character->MyInventoryComponentField();
+			if (inventory_component == nullptr)
+			{
+				return -1;
+			}
+
+			return API::InventoryIndex::Get().GetItemCount(inventory_component, item_class);
+		}
+
 		/**
 		 * \brief Returns IP address of player
 		 */
@@ -605,22 +762,10 @@ namespace ArkApi
 
 		uint64 GetSteamIDForPlayerID(int player_id) const
 		{
-			uint64 steam_id = GetShooterGameMode()->GetSteamIDForPlayerID(player_id);
+			uint64 steam_id = GetSteamIDForPlayerID_Internal(player_id);
 			if (steam_id == 0)
 			{
-				const auto& player_controllers = GetWorld()->PlayerControllerListField();
-				for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-
-					if (shooter_pc != nullptr && shooter_pc->LinkedPlayerIDField() == player_id)
-					{
-						steam_id = GetSteamIdFromController(shooter_pc);
-						break;
-					}
-				}
-
-				GetShooterGameMode()->AddPlayerID(player_id, steam_id);
+				steam_id = GetShooterGameMode()->GetSteamIDForPlayerID(player_id);
 			}
 
 			return steam_id;
@@ -640,14 +785,14 @@ namespace ArkApi
 		}
 
 		/**
-		 * \brief Returns blueprint path from any UClass
+		 * \brief Returns blueprint path from any UClass. The path is built once per class and cached
 		 */
 		static FORCEINLINE FString GetClassBlueprint(UClass* the_class)
 		{
-			if (the_class != nullptr)
+			return API::BlueprintCache::Get().GetClassBlueprint(the_class, [](UClass* blueprint_class)
 			{
 				FString path_name;
-				the_class->GetDefaultObject(true)->GetFullName(&path_name, nullptr);
+				blueprint_class->GetDefaultObject(true)->GetFullName(&path_name, nullptr);
 
 				if (int find_index = 0; path_name.FindChar(' ', find_index))
 				{
@@ -659,9 +804,9 @@ namespace ArkApi
 							: 1))) + "'";
 					return path_name.Replace(L"Default__", L"", ESearchCase::CaseSensitive);
 				}
-			}
 
-			return FString("");
+				return FString("");
+			});
 		}
 
 		/**
@@ -713,19 +858,31 @@ namespace ArkApi
 		/**
 		* \brief Gets all actors in radius at location, with ignore actors
 		*/
-		TArray<AActor*> GetAllActorsInRange(FVector location, float radius, EServerOctreeGroup::Type ActorType, TArray<AActor*> ignores)
+		TArray<AActor*> GetAllActorsInRange(FVector location, float radius, EServerOctreeGroup::Type ActorType, const TArray<AActor*>& ignores)
 		{
 			TArray<AActor*> out_actors;
 
 			UVictoryCore::ServerOctreeOverlapActors(&out_actors, GetWorld(), location, radius, ActorType, true);
 
-			for (AActor* ignore : ignores)
-				out_actors.Remove(ignore);
+			if (ignores.Num() > 0)
+			{
+				const std::unordered_set<AActor*> ignored(ignores.GetData(), ignores.GetData() + ignores.Num());
+				out_actors.RemoveAll([&ignored](AActor* actor) { return ignored.count(actor) != 0; });
+			}
 
 			return out_actors;
 		}
 	private:
 			virtual AShooterPlayerController* FindPlayerFromSteamId_Internal(uint64 steam_id) const = 0;
+			virtual AShooterPlayerController* FindPlayerFromSteamName_Internal(const FString& steam_name) const = 0;
+			virtual AShooterPlayerController* FindPlayerFromPlayerId_Internal(uint64 player_id) const = 0;
+			virtual TArray<AShooterPlayerController*> FindPlayerFromCharacterName_Internal(const FString& character_name,
+			                                                                              ESearchCase::Type search,
+			                                                                              bool full_match) const = 0;
+			virtual TArray<AShooterPlayerController*> FindPlayersFromTribeId_Internal(int tribe_id) const = 0;
+			virtual uint64 GetSteamIDForPlayerID_Internal(uint64 player_id) const = 0;
+			virtual TArray<AShooterPlayerController*> GetAudience_Internal(const BroadcastAudience& audience) const = 0;
+			virtual void Broadcast_Internal(const BroadcastAudience& audience, BroadcastMessage message, size_t batch_size) = 0;
 	};
 
 	ARK_API IApiUtils& APIENTRY GetApiUtils();
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+
+class FString;
+struct UObject;
+struct UClass;
+
+namespace API
+{
+	/**
+	 * \brief Caches objects loaded from blueprint paths and blueprint paths of classes.
+	 * Entries are validated against GUObjectArray on every hit, so objects freed by GC are loaded again.
+	 * Must be used from the game thread
+	 */
+	class BlueprintCache
+	{
+	public:
+		using PathBuilder = FString(*)(UClass*);
+
+		ARK_API static BlueprintCache& Get();
+
+		BlueprintCache(const BlueprintCache&) = delete;
+		BlueprintCache(BlueprintCache&&) = delete;
+		BlueprintCache& operator=(const BlueprintCache&) = delete;
+		BlueprintCache& operator=(BlueprintCache&&) = delete;
+
+		/**
+		 * \brief Returns the object of the blueprint path, StaticLoadObject is called only on a cache miss.
+		 * Paths are compared case-insensitively, surrounding whitespace is ignored
+		 * \param blueprint Blueprint path
+		 * \return Loaded object or nullptr
+		 */
+		ARK_API UObject* LoadObject(std::wstring_view blueprint);
+
+		ARK_API UObject* LoadObject(const FString& blueprint);
+
+		ARK_API UObject* LoadObject(const wchar_t* blueprint);
+
+		/**
+		 * \brief Returns the blueprint path of the class. The path is built by build_path once per class
+		 * \param the_class Class
+		 * \param build_path Builds the path if it isn't cached
+		 */
+		ARK_API FString GetClassBlueprint(UClass* the_class, PathBuilder build_path);
+
+		/**
+		 * \brief Loads the blueprint when the server is ready, or immediately if it already is
+		 */
+		ARK_API void Preload(const FString& blueprint);
+
+		/**
+		 * \brief Loads queued blueprints and blueprints listed in settings/BlueprintCache/Preload of config.json.
+		 * Called by the API when the server is ready
+		 */
+		void OnServerReady();
+
+		ARK_API void Clear();
+
+	private:
+		struct ObjectEntry
+		{
+			std::wstring path;
+			int object_index;
+			int serial_number;
+		};
+
+		struct PathEntry
+		{
+			std::wstring path;
+			int class_index;
+			int serial_number;
+		};
+
+		BlueprintCache() = default;
+		~BlueprintCache() = default;
+
+		static size_t Hash(std::wstring_view path);
+		static bool Equals(const std::wstring& folded, std::wstring_view path);
+		static std::wstring_view Trim(std::wstring_view path);
+
+		// Hash of the folded path, collisions are resolved by comparing the path
+		std::unordered_multimap<size_t, ObjectEntry> objects_;
+		std::unordered_map<UClass*, PathEntry> paths_;
+
+		std::vector<std::wstring> preload_queue_;
+		bool server_ready_{false};
+	};
+} // namespace API
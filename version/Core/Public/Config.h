@@ -0,0 +1,154 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+#include "json.hpp"
+
+namespace API
+{
+	/**
+	 * \brief Parses JSON config files once and keeps them in memory. Changed files are reloaded
+	 * in the background, subscribers are notified from the main thread
+	 */
+	class Config
+	{
+	public:
+		using Snapshot = std::shared_ptr<const nlohmann::json>;
+		using Callback = std::function<void(const Snapshot&)>;
+
+		ARK_API static Config& Get();
+
+		Config(const Config&) = delete;
+		Config(Config&&) = delete;
+		Config& operator=(const Config&) = delete;
+		Config& operator=(Config&&) = delete;
+
+		/**
+		 * \brief Returns the latest parsed version of the file. The file is read from disk only on the first call,
+		 * afterwards it is watched for changes
+		 * \param path Absolute path or path relative to the server binaries directory
+		 * \return Immutable snapshot, empty object if the file doesn't exist or couldn't be parsed
+		 */
+		ARK_API Snapshot GetSnapshot(const std::string& path);
+
+		/**
+		 * \brief Returns value from the latest snapshot of the file
+		 * \tparam T Value type
+		 * \param path Path of the config file
+		 * \param pointer JSON pointer to the value, e.g. "/settings/Enabled"
+		 * \param default_value Value which is returned if the key is missing or has a different type
+		 */
+		template <typename T>
+		T GetValue(const std::string& path, const std::string& pointer, T default_value)
+		{
+			return Find<T>(*GetSnapshot(path), pointer).value_or(std::move(default_value));
+		}
+
+		/**
+		 * \brief Calls the callback on the main thread each time a new version of the file is published
+		 * \param id Unique subscription id
+		 * \param path Path of the config file
+		 * \param callback Callback which receives the new snapshot
+		 */
+		ARK_API void Subscribe(const std::string& id, const std::string& path, const Callback& callback);
+
+		/**
+		 * \brief Calls the callback on the main thread when the value has changed in a new version of the file
+		 * \tparam T Value type
+		 * \param id Unique subscription id
+		 * \param path Path of the config file
+		 * \param pointer JSON pointer to the value
+		 * \param callback Callback which receives the new value
+		 */
+		template <typename T>
+		void Subscribe(const std::string& id, const std::string& path, const std::string& pointer,
+		               std::function<void(const T&)> callback)
+		{
+			auto last_value = std::make_shared<std::optional<T>>(Find<T>(*GetSnapshot(path), pointer));
+
+			Subscribe(id, path, [pointer, last_value, callback = std::move(callback)](const Snapshot& config)
+			{
+				auto value = Find<T>(*config, pointer);
+				if (!value || value == *last_value)
+				{
+					return;
+				}
+
+				*last_value = value;
+				callback(*value);
+			});
+		}
+
+		/**
+		 * \brief Removes a subscription
+		 * \return true if subscription was removed
+		 */
+		ARK_API bool Unsubscribe(const std::string& id);
+
+		/**
+		 * \brief Starts the thread which watches loaded files for changes. Called by the API from UEngine::Init,
+		 * files are read earlier from DllMain where no thread may be started under the loader lock
+		 */
+		void StartWatcher();
+
+		/**
+		 * \brief Reads a value from the snapshot, std::nullopt if it is missing or has a different type
+		 */
+		template <typename T>
+		static std::optional<T> Find(const nlohmann::json& config, const std::string& pointer)
+		{
+			try
+			{
+				const nlohmann::json::json_pointer json_pointer(pointer);
+				if (config.contains(json_pointer))
+				{
+					return config.at(json_pointer).get<T>();
+				}
+			}
+			catch (const nlohmann::json::exception&)
+			{
+			}
+
+			return std::nullopt;
+		}
+
+	private:
+		struct File
+		{
+			std::filesystem::path path;
+			Snapshot snapshot;
+			std::filesystem::file_time_type write_time;
+		};
+
+		struct Subscriber
+		{
+			std::string key;
+			Callback callback;
+		};
+
+		Config() = default;
+		~Config();
+
+		static std::string GetKey(const std::string& path, std::filesystem::path& full_path);
+		static Snapshot Parse(const std::filesystem::path& path);
+
+		void WatchFiles();
+		void Update();
+
+		std::unordered_map<std::string, File> files_;
+		std::unordered_map<std::string, Subscriber> subscribers_;
+		std::vector<std::string> changed_files_;
+		std::mutex mutex_;
+
+		bool watcher_started_{false};
+		bool tick_registered_{false};
+	};
+} // namespace API
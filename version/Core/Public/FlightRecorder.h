@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "API/Base.h"
+
+namespace API
+{
+	/**
+	 * \brief Always-on in-memory ring of recent events. Writers never block, the oldest events are overwritten.
+	 * The ring is written to logs/ on crash, on unhandled exceptions and on demand. First-chance exceptions which the
+	 * engine may still handle go to a separate file which is overwritten by later ones
+	 */
+	class FlightRecorder
+	{
+	public:
+		enum class Category : uint8_t
+		{
+			Hook,
+			Command,
+			Request,
+			Plugin,
+			Custom
+		};
+
+		ARK_API static FlightRecorder& Get();
+
+		FlightRecorder(const FlightRecorder&) = delete;
+		FlightRecorder(FlightRecorder&&) = delete;
+		FlightRecorder& operator=(const FlightRecorder&) = delete;
+		FlightRecorder& operator=(FlightRecorder&&) = delete;
+
+		/**
+		 * \brief Records an event. Text longer than the slot is truncated
+		 * \param category Event category
+		 * \param text Event description
+		 */
+		ARK_API void Record(Category category, std::string_view text) noexcept;
+
+		/**
+		 * \brief Records an event, non-ASCII characters are replaced with '?'
+		 */
+		ARK_API void Record(Category category, std::wstring_view text) noexcept;
+
+		/**
+		 * \brief Writes recorded events to logs/FlightRecorder_<pid>_<time>.log
+		 * \param reason Written to the first line of the file
+		 * \return Path of the written file, empty string on failure
+		 */
+		ARK_API std::string Dump(const std::string& reason);
+
+		/**
+		 * \brief Installs unhandled exception filter, vectored handler for first-chance exceptions and terminate handler.
+		 * Called by the API on startup
+		 */
+		void InstallCrashHandlers();
+
+	private:
+		struct Slot;
+
+		FlightRecorder();
+		~FlightRecorder() = default;
+
+		template <typename CharT>
+		void RecordText(Category category, std::basic_string_view<CharT> text) noexcept;
+
+		/**
+		 * \brief Writes the ring without heap allocations, safe to call from exception handlers
+		 */
+		bool WriteRing(const char* path, const char* reason) const noexcept;
+
+		static LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* exception_info);
+		static LONG WINAPI OnVectoredException(EXCEPTION_POINTERS* exception_info);
+		static void OnTerminate();
+		static void DumpCrash(const char* reason) noexcept;
+		static void DumpFirstChance(const EXCEPTION_RECORD& record) noexcept;
+
+		std::unique_ptr<Slot[]> slots_;
+		std::atomic<uint64_t> next_{0};
+
+		char crash_path_[MAX_PATH]{};
+		std::atomic<bool> crash_dumped_{false};
+
+		char first_chance_path_[MAX_PATH]{};
+		std::atomic<ULONGLONG> last_first_chance_ms_{0};
+		LPTOP_LEVEL_EXCEPTION_FILTER previous_filter_{nullptr};
+	};
+} // namespace API
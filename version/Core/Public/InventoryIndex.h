@@ -0,0 +1,123 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+
+struct UClass;
+struct UPrimalInventoryComponent;
+struct UPrimalItem;
+
+namespace API
+{
+	/**
+	 * \brief Per-inventory index of items by class with total quantities. An inventory is indexed on the first lookup
+	 * and kept current from the item added, removed and quantity updated notifications of the inventory. A lookup
+	 * rebuilds the index only if InventoryItems changed without a notification.
+	 * Only items of InventoryItems are indexed, equipped items aren't. Indices of destroyed inventories are dropped
+	 * by a sweep once per second. Must be used from the game thread
+	 */
+	class InventoryIndex
+	{
+	public:
+		ARK_API static InventoryIndex& Get();
+
+		InventoryIndex(const InventoryIndex&) = delete;
+		InventoryIndex(InventoryIndex&&) = delete;
+		InventoryIndex& operator=(const InventoryIndex&) = delete;
+		InventoryIndex& operator=(InventoryIndex&&) = delete;
+
+		/**
+		 * \brief Returns the total quantity of items of the class in the inventory
+		 */
+		ARK_API int GetItemCount(UPrimalInventoryComponent* inventory, UClass* item_class);
+
+		/**
+		 * \brief Returns items of the class in the inventory. The array is invalidated by the next inventory change
+		 */
+		ARK_API const std::vector<UPrimalItem*>& GetItems(UPrimalInventoryComponent* inventory, UClass* item_class);
+
+		/**
+		 * \brief Drops the index of the inventory, it is rebuilt on the next lookup
+		 */
+		ARK_API void Invalidate(UPrimalInventoryComponent* inventory);
+
+		void OnItemAdded(UPrimalInventoryComponent* inventory, UPrimalItem* item);
+		void OnItemRemoved(UPrimalInventoryComponent* inventory, UPrimalItem* item);
+		void OnItemQuantityUpdated(UPrimalInventoryComponent* inventory, UPrimalItem* item);
+
+	private:
+		struct ClassItems
+		{
+			std::vector<UPrimalItem*> items;
+			int quantity{0};
+
+			// Generation of the index when the items were last checked to be alive
+			unsigned checked_generation{0};
+		};
+
+		struct ItemEntry
+		{
+			UClass* item_class;
+			int quantity;
+
+			// Weak reference to the item, a freed item's address can be reused by another one
+			int object_index;
+			int serial_number;
+		};
+
+		struct Index
+		{
+			// Weak reference to the inventory, the address can be reused after GC
+			int object_index;
+			int serial_number;
+
+			std::unordered_map<UClass*, ClassItems> classes;
+			std::unordered_map<UPrimalItem*, ItemEntry> items;
+
+			// Bumped by every notification
+			unsigned generation{0};
+
+			// InventoryItems as seen by the first lookup after a notification. If the array differs while the
+			// generation is unchanged, items were moved without a notification
+			unsigned array_generation{0};
+			const void* array_data{nullptr};
+			int array_num{0};
+		};
+
+		InventoryIndex() = default;
+		~InventoryIndex();
+
+		/**
+		 * \brief Returns an up to date index of the inventory, builds it if needed
+		 */
+		Index* GetIndex(UPrimalInventoryComponent* inventory);
+
+		/**
+		 * \brief Indexes all items of InventoryItems
+		 */
+		Index* Build(UPrimalInventoryComponent* inventory);
+
+		/**
+		 * \brief Returns the index only if it was already built
+		 */
+		Index* FindIndex(UPrimalInventoryComponent* inventory);
+
+		/**
+		 * \brief Checks that all items of the class are alive, once per generation of the index
+		 */
+		static bool IsAlive(Index& index, ClassItems& class_items);
+
+		/**
+		 * \brief Drops indices of inventories which no longer resolve
+		 */
+		void Sweep();
+
+		static void Add(Index& index, UPrimalItem* item);
+		static void Remove(Index& index, UPrimalItem* item);
+
+		std::unordered_map<UPrimalInventoryComponent*, Index> indices_;
+		bool timer_registered_{false};
+	};
+} // namespace API
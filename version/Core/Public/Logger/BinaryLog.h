@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+#include "BinaryLogFormat.h"
+
+namespace API
+{
+	/**
+	 * \brief Deferred formatting log. The caller only copies the format id and raw arguments into a per-thread buffer,
+	 * formatting is done by a background thread or offline by the decoder tool
+	 */
+	class BinaryLog
+	{
+	public:
+		ARK_API static BinaryLog& Get();
+
+		BinaryLog(const BinaryLog&) = delete;
+		BinaryLog(BinaryLog&&) = delete;
+		BinaryLog& operator=(const BinaryLog&) = delete;
+		BinaryLog& operator=(BinaryLog&&) = delete;
+
+		/**
+		 * \brief Registers a call site. Called once per call site by BINARY_LOG
+		 * \return Format id
+		 */
+		ARK_API uint32_t RegisterFormat(const std::string& logger_name, spdlog::level::level_enum level,
+		                                const char* file, int line, const char* format);
+
+		/**
+		 * \brief Writes an encoded message into the buffer of the current thread
+		 */
+		ARK_API void Write(const char* data, size_t size);
+
+		/**
+		 * \brief Returns amount of messages dropped because the thread buffer was full
+		 */
+		ARK_API size_t GetDroppedCount() const;
+
+		/**
+		 * \brief Format id of a BINARY_LOG call site, registered by its first message
+		 */
+		struct CallSite
+		{
+			std::once_flag once;
+			uint32_t format_id{0};
+		};
+
+		/**
+		 * \brief Registers the call site on its first use and appends the message. The format string is passed with
+		 * the arguments, so BINARY_LOG works without arguments and evaluates each of them once
+		 */
+		template <typename... Args>
+		void Append(CallSite& site, const std::string& logger_name, spdlog::level::level_enum level, const char* file,
+		            int line, const char* format, const Args&... args)
+		{
+			std::call_once(site.once, [&]
+			{
+				site.format_id = RegisterFormat(logger_name, level, file, line, format);
+			});
+
+			Append(site.format_id, args...);
+		}
+
+		template <typename... Args>
+		void Append(uint32_t format_id, const Args&... args)
+		{
+			thread_local std::string buffer;
+			buffer.clear();
+
+			BinaryLogFormat::Writer writer(buffer);
+			writer.Put(format_id);
+			writer.Put(static_cast<uint32_t>(spdlog::details::os::thread_id()));
+			writer.Put(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count()));
+
+			(writer.PutArg(args), ...);
+
+			Write(buffer.data(), buffer.size());
+		}
+
+	private:
+		struct ThreadBuffer;
+
+		BinaryLog();
+		~BinaryLog() = default;
+
+		std::shared_ptr<ThreadBuffer> CreateThreadBuffer();
+
+		void Run();
+		void SyncFormats();
+		void Process(const std::string& record);
+		void WriteRecord(BinaryLogFormat::RecordType type, const std::string& payload);
+
+		enum class Output
+		{
+			// Messages are formatted by the background thread and written to the regular log
+			Text,
+			// Messages are written to logs/ArkApi_<pid>.blog and formatted by the decoder tool
+			File
+		};
+
+		Output output_{Output::Text};
+		size_t buffer_size_{256 * 1024};
+
+		std::vector<BinaryLogFormat::FormatInfo> formats_;
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+		std::mutex mutex_;
+		bool worker_started_{false};
+
+		std::atomic<size_t> dropped_{0};
+
+		// Used by the worker thread only
+		std::vector<BinaryLogFormat::FormatInfo> worker_formats_;
+		std::vector<BinaryLogFormat::Arg> args_;
+		std::ofstream file_;
+	};
+} // namespace API
+
+/**
+ * \brief Logs with deferred formatting. Arguments are copied as raw values, FString is copied as UTF-16
+ * \param level spdlog::level of the message
+ * \param ... fmt-style format string literal followed by the arguments, if any
+ */
+#define BINARY_LOG(level, ...) \
+	do \
+	{ \
+		auto& binary_logger = Log::GetLog(); \
+		if (binary_logger && binary_logger->should_log(level)) \
+		{ \
+			static API::BinaryLog::CallSite binary_log_site; \
+			API::BinaryLog::Get().Append(binary_log_site, binary_logger->name(), level, __FILE__, __LINE__, \
+			                             __VA_ARGS__); \
+		} \
+	} while (false)
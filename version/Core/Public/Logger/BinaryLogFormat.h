@@ -0,0 +1,422 @@
+#pragma once
+
+// Record layout of the binary log. Doesn't depend on Windows headers, it is shared with the offline decoder
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "spdlog/fmt/fmt.h"
+
+namespace API
+{
+	namespace BinaryLogFormat
+	{
+		constexpr char file_magic[8] = {'A', 'R', 'K', 'B', 'L', 'O', 'G', '1'};
+
+		/**
+		 * \brief File consists of the magic followed by [type:u8][size:u32][payload] records.
+		 * Format payload: id:u32, level:u8, line:u32, logger:str, file:str, format:str
+		 * Message payload: format_id:u32, thread_id:u32, time_ns:i64, arguments
+		 */
+		enum class RecordType : uint8_t
+		{
+			Format = 1,
+			Message = 2
+		};
+
+		/**
+		 * \brief Argument is stored as [type:u8][value]. Strings are [length:u32][bytes],
+		 * wide strings are [length:u32][UTF-16 code units]
+		 */
+		enum class ArgType : uint8_t
+		{
+			Signed = 1,
+			Unsigned,
+			Double,
+			Bool,
+			String,
+			WideString,
+			Pointer
+		};
+
+		template <typename T, typename = void>
+		struct IsTextArray : std::false_type
+		{
+		};
+
+		// FString and similar containers of TCHAR
+		template <typename T>
+		struct IsTextArray<T, std::void_t<decltype(std::declval<const T&>().Len()),
+		                                  decltype(static_cast<const wchar_t*>(*std::declval<const T&>()))>>
+			: std::true_type
+		{
+		};
+
+		class Writer
+		{
+		public:
+			explicit Writer(std::string& buffer)
+				: buffer_(buffer)
+			{
+			}
+
+			template <typename T>
+			void Put(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			void PutString(std::string_view value)
+			{
+				Put(static_cast<uint32_t>(value.size()));
+				buffer_.append(value.data(), value.size());
+			}
+
+			void PutWideString(const wchar_t* value, size_t length)
+			{
+				Put(static_cast<uint32_t>(length));
+				for (size_t i = 0; i < length; ++i)
+				{
+					Put(static_cast<uint16_t>(value[i]));
+				}
+			}
+
+			template <typename T>
+			void PutArg(const T& value)
+			{
+				using Type = std::decay_t<T>;
+
+				if constexpr (std::is_same_v<Type, bool>)
+				{
+					Put(ArgType::Bool);
+					Put(static_cast<uint8_t>(value));
+				}
+				else if constexpr (std::is_same_v<Type, char>)
+				{
+					Put(ArgType::String);
+					PutString(std::string_view(&value, 1));
+				}
+				else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+				{
+					Put(ArgType::String);
+					PutString(value ? value : "(null)");
+				}
+				else if constexpr (std::is_same_v<Type, const wchar_t*> || std::is_same_v<Type, wchar_t*>)
+				{
+					const std::wstring_view view(value ? value : L"(null)");
+
+					Put(ArgType::WideString);
+					PutWideString(view.data(), view.size());
+				}
+				else if constexpr (std::is_enum_v<Type>)
+				{
+					PutArg(static_cast<std::underlying_type_t<Type>>(value));
+				}
+				else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+				{
+					Put(ArgType::Signed);
+					Put(static_cast<int64_t>(value));
+				}
+				else if constexpr (std::is_integral_v<Type>)
+				{
+					Put(ArgType::Unsigned);
+					Put(static_cast<uint64_t>(value));
+				}
+				else if constexpr (std::is_floating_point_v<Type>)
+				{
+					Put(ArgType::Double);
+					Put(static_cast<double>(value));
+				}
+				else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				{
+					Put(ArgType::String);
+					PutString(std::string_view(value));
+				}
+				else if constexpr (std::is_convertible_v<const T&, std::wstring_view>)
+				{
+					const std::wstring_view view(value);
+
+					Put(ArgType::WideString);
+					PutWideString(view.data(), view.size());
+				}
+				else if constexpr (IsTextArray<Type>::value)
+				{
+					Put(ArgType::WideString);
+					PutWideString(*value, static_cast<size_t>(value.Len()));
+				}
+				else if constexpr (std::is_pointer_v<Type>)
+				{
+					Put(ArgType::Pointer);
+					Put(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+				}
+				else
+				{
+					static_assert(!sizeof(Type), "Unsupported binary log argument type");
+				}
+			}
+
+		private:
+			std::string& buffer_;
+		};
+
+		class Reader
+		{
+		public:
+			Reader(const char* data, size_t size)
+				: data_(data),
+				  size_(size)
+			{
+			}
+
+			template <typename T>
+			bool Read(T& value)
+			{
+				if (size_ - pos_ < sizeof(T))
+				{
+					return false;
+				}
+
+				memcpy(&value, data_ + pos_, sizeof(T));
+				pos_ += sizeof(T);
+				return true;
+			}
+
+			bool ReadString(std::string& value)
+			{
+				uint32_t length;
+				if (!Read(length) || size_ - pos_ < length)
+				{
+					return false;
+				}
+
+				value.assign(data_ + pos_, length);
+				pos_ += length;
+				return true;
+			}
+
+			bool AtEnd() const { return pos_ >= size_; }
+
+		private:
+			const char* data_;
+			size_t size_;
+			size_t pos_{0};
+		};
+
+		struct Arg
+		{
+			ArgType type{ArgType::Signed};
+			int64_t signed_value{0};
+			uint64_t unsigned_value{0};
+			double double_value{0};
+			std::string string_value;
+		};
+
+		struct FormatInfo
+		{
+			uint32_t id{0};
+			uint8_t level{0};
+			uint32_t line{0};
+			std::string logger;
+			std::string file;
+			std::string format;
+		};
+
+		inline bool ReadFormatInfo(Reader& reader, FormatInfo& info)
+		{
+			return reader.Read(info.id) && reader.Read(info.level) && reader.Read(info.line)
+				&& reader.ReadString(info.logger) && reader.ReadString(info.file) && reader.ReadString(info.format);
+		}
+
+		inline void WriteFormatInfo(Writer& writer, const FormatInfo& info)
+		{
+			writer.Put(info.id);
+			writer.Put(info.level);
+			writer.Put(info.line);
+			writer.PutString(info.logger);
+			writer.PutString(info.file);
+			writer.PutString(info.format);
+		}
+
+		inline std::string Utf16ToUtf8(const std::vector<uint16_t>& units)
+		{
+			std::string result;
+			result.reserve(units.size());
+
+			for (size_t i = 0; i < units.size(); ++i)
+			{
+				uint32_t code = units[i];
+
+				if (code >= 0xD800 && code <= 0xDBFF && i + 1 < units.size()
+					&& units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF)
+				{
+					code = 0x10000 + ((code - 0xD800) << 10) + (units[++i] - 0xDC00);
+				}
+
+				if (code < 0x80)
+				{
+					result += static_cast<char>(code);
+				}
+				else if (code < 0x800)
+				{
+					result += static_cast<char>(0xC0 | code >> 6);
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000)
+				{
+					result += static_cast<char>(0xE0 | code >> 12);
+					result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else
+				{
+					result += static_cast<char>(0xF0 | code >> 18);
+					result += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+					result += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+			}
+
+			return result;
+		}
+
+		inline bool ReadArgs(Reader& reader, std::vector<Arg>& args)
+		{
+			args.clear();
+
+			while (!reader.AtEnd())
+			{
+				Arg arg;
+				if (!reader.Read(arg.type))
+				{
+					return false;
+				}
+
+				bool valid = true;
+
+				switch (arg.type)
+				{
+				case ArgType::Signed:
+					valid = reader.Read(arg.signed_value);
+					break;
+				case ArgType::Unsigned:
+				case ArgType::Pointer:
+					valid = reader.Read(arg.unsigned_value);
+					break;
+				case ArgType::Double:
+					valid = reader.Read(arg.double_value);
+					break;
+				case ArgType::Bool:
+				{
+					uint8_t value;
+					valid = reader.Read(value);
+					arg.unsigned_value = value;
+					break;
+				}
+				case ArgType::String:
+					valid = reader.ReadString(arg.string_value);
+					break;
+				case ArgType::WideString:
+				{
+					uint32_t length;
+					valid = reader.Read(length);
+
+					std::vector<uint16_t> units(valid ? length : 0);
+					for (uint32_t i = 0; valid && i < length; ++i)
+					{
+						valid = reader.Read(units[i]);
+					}
+
+					arg.string_value = Utf16ToUtf8(units);
+					break;
+				}
+				default:
+					valid = false;
+				}
+
+				if (!valid)
+				{
+					return false;
+				}
+
+				args.push_back(std::move(arg));
+			}
+
+			return true;
+		}
+
+		inline std::string FormatArg(const std::string& spec, const Arg& arg)
+		{
+			const std::string format = "{" + (spec.empty() ? "" : ":" + spec) + "}";
+
+			try
+			{
+				switch (arg.type)
+				{
+				case ArgType::Signed:
+					return fmt::format(format, arg.signed_value);
+				case ArgType::Unsigned:
+					return fmt::format(format, arg.unsigned_value);
+				case ArgType::Double:
+					return fmt::format(format, arg.double_value);
+				case ArgType::Bool:
+					return fmt::format(format, arg.unsigned_value != 0);
+				case ArgType::Pointer:
+					return fmt::format(format, reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.unsigned_value)));
+				default:
+					return fmt::format(format, arg.string_value);
+				}
+			}
+			catch (const fmt::FormatError&)
+			{
+				return "{" + spec + "?}";
+			}
+		}
+
+		/**
+		 * \brief Substitutes {}, {index} and {:spec} placeholders, same as fmt::format
+		 */
+		inline std::string FormatText(const std::string& format, const std::vector<Arg>& args)
+		{
+			std::string result;
+			result.reserve(format.size() + args.size() * 8);
+
+			size_t next_index = 0;
+
+			for (size_t i = 0; i < format.size(); ++i)
+			{
+				const char c = format[i];
+
+				if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c)
+				{
+					result += c;
+					++i;
+					continue;
+				}
+
+				const size_t end = c == '{' ? format.find('}', i) : std::string::npos;
+				if (end == std::string::npos)
+				{
+					result += c;
+					continue;
+				}
+
+				const std::string placeholder = format.substr(i + 1, end - i - 1);
+				const size_t colon = placeholder.find(':');
+				const std::string index_str = placeholder.substr(0, colon);
+				const std::string spec = colon != std::string::npos ? placeholder.substr(colon + 1) : "";
+
+				const size_t index = index_str.empty() ? next_index++ : strtoul(index_str.c_str(), nullptr, 10);
+
+				result += index < args.size() ? FormatArg(spec, args[index]) : "{?}";
+				i = end;
+			}
+
+			return result;
+		}
+	} // namespace BinaryLogFormat
+} // namespace API
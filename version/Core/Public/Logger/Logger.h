@@ -1,10 +1,24 @@
 #pragma once
 
+#include <atomic>
+
 #include "../API/Base.h"
 #include "Logger/spdlog/spdlog.h"
 
 ARK_API std::vector<spdlog::sink_ptr>& APIENTRY GetLogSinks();
 
+/**
+ * \brief Returns amount of messages dropped because the log queue was full
+ */
+ARK_API size_t APIENTRY GetLogDroppedCount();
+
+/**
+ * \brief Waits at most timeout_ms until queued log messages are written and the log files are flushed.
+ * Messages which are still queued then are written on the calling thread
+ * \return true if all messages were written
+ */
+ARK_API bool APIENTRY FlushLogs(unsigned timeout_ms);
+
 class Log
 {
 public:
@@ -31,7 +45,8 @@ public:
 		logger_ = std::make_shared<spdlog::logger>(plugin_name, begin(sinks), end(sinks));
 
 		logger_->set_pattern("%D %R [%n][%l] %v");
-		logger_->flush_on(spdlog::level::info);
+		// Flushing waits for the background writer, only errors are worth it
+		logger_->flush_on(spdlog::level::err);
 	}
 
 private:
@@ -40,3 +55,124 @@ private:
 
 	std::shared_ptr<spdlog::logger> logger_;
 };
+
+class LogRateLimit;
+
+/**
+ * \brief Adds a call site with suppressed messages to the sites checked by FlushLogRateLimits
+ */
+ARK_API void APIENTRY RegisterLogRateLimit(LogRateLimit* site);
+ARK_API void APIENTRY UnregisterLogRateLimit(LogRateLimit* site);
+
+/**
+ * \brief Reports suppressed messages of call sites whose interval has passed. Called by the API every second
+ */
+ARK_API void APIENTRY FlushLogRateLimits();
+
+/**
+ * \brief State of a rate-limited log call site, see LOG_RATE_LIMITED
+ */
+class LogRateLimit
+{
+public:
+	LogRateLimit(spdlog::level::level_enum level, const char* file, int line)
+		: level_(level),
+		  file_(file),
+		  line_(line)
+	{
+	}
+
+	~LogRateLimit()
+	{
+		if (registered_.load(std::memory_order_relaxed))
+		{
+			UnregisterLogRateLimit(this);
+		}
+	}
+
+	LogRateLimit(const LogRateLimit&) = delete;
+	LogRateLimit& operator=(const LogRateLimit&) = delete;
+
+	/**
+	 * \brief Returns true if the message should be written
+	 * \param interval_ms Minimal time between two written messages
+	 * \param suppressed Receives amount of messages suppressed since the last written one
+	 */
+	bool Allow(unsigned long long interval_ms, size_t& suppressed)
+	{
+		const unsigned long long now = GetTickCount64();
+
+		unsigned long long next_allowed = next_allowed_.load(std::memory_order_relaxed);
+		if (now < next_allowed
+			|| !next_allowed_.compare_exchange_strong(next_allowed, now + interval_ms, std::memory_order_relaxed))
+		{
+			suppressed_.fetch_add(1, std::memory_order_relaxed);
+
+			// Sites are registered on their first suppressed message only
+			if (!registered_.load(std::memory_order_relaxed) && !registered_.exchange(true))
+			{
+				logger_ = Log::GetLog();
+				RegisterLogRateLimit(this);
+			}
+
+			return false;
+		}
+
+		suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	/**
+	 * \brief Writes the amount of suppressed messages once the interval has passed, even if no message follows
+	 */
+	void Flush()
+	{
+		if (GetTickCount64() < next_allowed_.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		const size_t suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+		if (suppressed > 0 && logger_)
+		{
+			logger_->log(level_, "Suppressed {} similar messages ({}:{})", suppressed, file_, line_);
+		}
+	}
+
+private:
+	std::atomic<unsigned long long> next_allowed_{0};
+	std::atomic<size_t> suppressed_{0};
+
+	spdlog::level::level_enum level_;
+	const char* file_;
+	int line_;
+
+	std::shared_ptr<spdlog::logger> logger_;
+	std::atomic<bool> registered_{false};
+};
+
+/**
+ * \brief Writes at most one message per interval from this call site. Amount of suppressed messages
+ * is reported together with the next written one, or within a second after the interval has passed
+ * \param level spdlog::level of the message
+ * \param interval_ms Minimal time between two messages in milliseconds
+ */
+#define LOG_RATE_LIMITED(level, interval_ms, ...) \
+	do \
+	{ \
+		auto& rate_limited_logger = Log::GetLog(); \
+		if (rate_limited_logger && rate_limited_logger->should_log(level)) \
+		{ \
+			static LogRateLimit log_rate_limit(level, __FILE__, __LINE__); \
+			size_t log_suppressed = 0; \
+			if (log_rate_limit.Allow(interval_ms, log_suppressed)) \
+			{ \
+				if (log_suppressed > 0) \
+				{ \
+					rate_limited_logger->log(level, "Suppressed {} similar messages ({}:{})", log_suppressed, \
+					                         __FILE__, __LINE__); \
+				} \
+				rate_limited_logger->log(level, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+
+struct UObject;
+struct UClass;
+
+namespace API
+{
+	/**
+	 * \brief Index of GUObjectArray by object name. Classes are also indexed by full name.
+	 * The array is scanned in fixed-size chunks on every tick, slots which changed since the previous pass are
+	 * re-indexed, so a pass never stalls a frame. Must be used from the game thread
+	 */
+	class ObjectNameIndex
+	{
+	public:
+		ARK_API static ObjectNameIndex& Get();
+
+		ObjectNameIndex(const ObjectNameIndex&) = delete;
+		ObjectNameIndex(ObjectNameIndex&&) = delete;
+		ObjectNameIndex& operator=(const ObjectNameIndex&) = delete;
+		ObjectNameIndex& operator=(ObjectNameIndex&&) = delete;
+
+		/**
+		 * \brief Finds a class by full name, e.g. "Class /Script/Engine.TriggerSphere", or by short name,
+		 * e.g. "TriggerSphere"
+		 * \return Class or nullptr
+		 */
+		ARK_API UClass* FindClass(const std::string& name);
+
+		/**
+		 * \brief Finds an object by name, e.g. "Default__PrimalItem_WeaponRifle_C".
+		 * If several objects have the same name any of them may be returned
+		 * \return Object or nullptr
+		 */
+		ARK_API UObject* FindObjectByName(const std::string& name);
+
+		/**
+		 * \brief Starts building the index in the background. Called by the API when the server is ready,
+		 * otherwise the first lookup starts it
+		 */
+		void Start();
+
+	private:
+		struct Slot
+		{
+			UObject* object{nullptr};
+			uint64_t name{0};
+			// Set for classes only
+			std::string full_name;
+		};
+
+		ObjectNameIndex() = default;
+		~ObjectNameIndex();
+
+		static uint64_t NameKey(int comparison_index, unsigned int number);
+		static bool HasName(UObject* object, uint64_t name);
+
+		void Update();
+		void Scan(int begin, int end);
+		void IndexSlot(int index, UObject* object);
+		void RemoveSlot(int index);
+
+		/**
+		 * \brief Brings every slot up to date before a lookup reports a miss
+		 */
+		void CatchUp();
+
+		UObject* GetLiveObject(int index) const;
+
+		std::vector<Slot> slots_;
+		std::unordered_multimap<uint64_t, int> objects_by_name_;
+		std::unordered_map<std::string, int> classes_by_full_name_;
+		std::unordered_multimap<std::string, int> classes_by_short_name_;
+
+		int cursor_{0};
+		bool complete_{false};
+		bool started_{false};
+	};
+} // namespace API
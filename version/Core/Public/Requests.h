@@ -1,12 +1,142 @@
 #pragma once
 
 #include <functional>
+#include <fstream>
+#include <memory>
 #include <vector>
 #include <mutex>
+#include <type_traits>
+#include <unordered_map>
 #include "API/Base.h"
 
 namespace API
 {
+	/**
+	 * \brief Full result of a request created with Requests::CreateRequest
+	 */
+	struct Response
+	{
+		int status{0};
+		std::string reason;
+		std::string body;
+
+		// Header names are lower-cased
+		std::unordered_map<std::string, std::string> headers;
+
+		std::string GetHeader(const std::string& name) const
+		{
+			const auto iter = headers.find(name);
+			return iter != headers.end() ? iter->second : "";
+		}
+	};
+
+	/**
+	 * \brief Receives the response body of a streaming request in chunks. All functions are called from the request thread
+	 */
+	class ResponseSink
+	{
+	public:
+		virtual ~ResponseSink() = default;
+
+		/**
+		 * \brief Called once with status and headers before the first chunk
+		 * \return false to abort the request
+		 */
+		virtual bool Begin(const Response& /*response*/) { return true; }
+
+		/**
+		 * \brief Called for each received chunk of the body
+		 * \return false to abort the request
+		 */
+		virtual bool Write(const char* data, size_t size) = 0;
+
+		/**
+		 * \brief Called once after the body was received or the request failed
+		 * \return Small result which is passed to the callback as the response body (path, digest, parsed summary...)
+		 */
+		virtual std::string Finish(bool success) = 0;
+	};
+
+	/**
+	 * \brief Writes the response body straight to disk. Data goes to "<path>.part" which is renamed to path on success
+	 */
+	class FileSink : public ResponseSink
+	{
+	public:
+		ARK_API explicit FileSink(std::string path);
+
+		ARK_API bool Begin(const Response& response) override;
+		ARK_API bool Write(const char* data, size_t size) override;
+		ARK_API std::string Finish(bool success) override;
+
+	private:
+		std::string path_;
+		std::string temp_path_;
+		std::ofstream file_;
+	};
+
+	/**
+	 * \brief Options of Requests::CreateCachedGetRequest. Only vary_headers is part of the cache key, requests which
+	 * join a running fetch of the same key get the result stored with the options of the first request
+	 */
+	struct CacheOptions
+	{
+		// Used when the response has no Cache-Control max-age
+		int default_ttl_seconds{0};
+
+		// Request headers which are part of the cache key (e.g. Authorization)
+		std::vector<std::string> vary_headers;
+
+		// Store responses on disk as well, the disk tier is shared by all servers running from the same directory
+		bool use_disk{true};
+
+		size_t max_memory_entries{512};
+	};
+
+	/**
+	 * \brief Timeouts, retries and circuit breaker settings, set globally or per host
+	 */
+	struct RequestPolicy
+	{
+		int connect_timeout_ms{10000};
+		int read_timeout_ms{30000};
+
+		// Upper limit for all attempts of a request including backoff and reading the body, socket timeouts are clamped to the remaining time
+		int total_timeout_ms{60000};
+
+		// Retries of connection errors, timeouts, 429 and 502-504. Only idempotent methods (GET, HEAD, PUT, DELETE, OPTIONS) are retried
+		int max_retries{2};
+		int base_backoff_ms{250};
+		int max_backoff_ms{5000};
+
+		// Consecutive failures (connection errors, timeouts and 5xx) after which the host is failed fast, 0 disables the breaker
+		int breaker_failure_threshold{5};
+
+		// Time the circuit stays open before a single probe request is let through
+		int breaker_open_ms{30000};
+	};
+
+	enum class CircuitState
+	{
+		Closed,
+		Open,
+		HalfOpen
+	};
+
+	struct HostStats
+	{
+		CircuitState state{CircuitState::Closed};
+		int consecutive_failures{0};
+
+		size_t attempts{0};
+		size_t retries{0};
+		size_t failures{0};
+		size_t timeouts{0};
+
+		// Requests failed fast because the circuit was open
+		size_t rejected{0};
+	};
+
 	class Requests
 	{
 	public:
@@ -79,7 +209,126 @@ namespace API
 		ARK_API bool CreateDeleteRequest(const std::string& url,
 			const std::function<void(bool, std::string)>& callback,
 			std::vector<std::string> headers = {});
+
+		/**
+		 * \brief Creates an async Request of any method that runs in another thread but calls the callback from the main thread
+		 * \param request method (GET, POST, PUT, PATCH, DELETE...)
+		 * \param request URL
+		 * \param the callback function, binds sucess(bool) and the full response (status, headers and body), body is read for every status code
+		 * \param data to send, ignored if empty
+		 * \param content type of the data
+		 * \param included headers
+		 */
+		ARK_API bool CreateRequest(const std::string& method, const std::string& url,
+			const std::function<void(bool, Response)>& callback,
+			const std::string& body = "",
+			const std::string& content_type = "application/json",
+			std::vector<std::string> headers = {});
+
+		/**
+		 * \brief Creates an async streaming Request. The body is passed to the sink in chunks from the request thread and never buffered in memory.
+		 * Only the sink result is passed to the callback, which is called from the main thread
+		 * \param request method
+		 * \param request URL
+		 * \param sink which receives the body of a successful (2xx) response
+		 * \param the callback function, binds sucess(bool) and the response, response body is the result of ResponseSink::Finish
+		 * \param data to send, ignored if empty
+		 * \param content type of the data
+		 * \param included headers
+		 */
+		ARK_API bool CreateStreamRequest(const std::string& method, const std::string& url,
+			std::shared_ptr<ResponseSink> sink,
+			const std::function<void(bool, Response)>& callback,
+			const std::string& body = "",
+			const std::string& content_type = "application/json",
+			std::vector<std::string> headers = {});
+
+		/**
+		 * \brief Downloads a file to disk without buffering it in memory, calls the callback from the main thread
+		 * \param request URL
+		 * \param destination file path
+		 * \param the callback function, binds sucess(bool) and result(string), result is error code if request failed and the file path otherwise
+		 * \param included headers
+		 */
+		ARK_API bool CreateDownloadRequest(const std::string& url, const std::string& file_path,
+			const std::function<void(bool, std::string)>& callback,
+			std::vector<std::string> headers = {});
+
+		/**
+		 * \brief Creates an async GET Request which is answered from the cache when possible.
+		 * Honors Cache-Control (max-age, no-cache, no-store) and revalidates stale entries with ETag/Last-Modified.
+		 * Concurrent requests for the same URL and vary headers share a single fetch. The fetch runs with the options of
+		 * the request which started it, e.g. its default TTL and use_disk, options of joining requests are ignored
+		 * \param request URL
+		 * \param the callback function, binds sucess(bool) and result(string), result is error code if request failed and the response otherwise
+		 * \param included headers
+		 * \param cache options
+		 */
+		ARK_API bool CreateCachedGetRequest(const std::string& url,
+			const std::function<void(bool, std::string)>& callback,
+			std::vector<std::string> headers = {},
+			const CacheOptions& options = {});
+
+		/**
+		 * \brief Sets the policy used for hosts without their own policy
+		 */
+		ARK_API void SetDefaultPolicy(const RequestPolicy& policy);
+
+		/**
+		 * \brief Sets the policy for a single host
+		 * \param host name, e.g. "discord.com"
+		 * \param policy policy
+		 */
+		ARK_API void SetHostPolicy(const std::string& host, const RequestPolicy& policy);
+
+		/**
+		 * \brief Returns circuit state and counters of every host that was requested
+		 */
+		ARK_API std::unordered_map<std::string, HostStats> GetHostStats();
+
+		/**
+		 * \brief Creates an async Request whose response is post-processed on the request thread.
+		 * Use it to parse or validate large responses without stalling the main thread
+		 * \tparam Transform Callable T(Response&), called from the request thread only for successful (2xx) responses
+		 * \tparam Completion Callable void(bool, T), called from the main thread. T must be default constructible
+		 * \param method request method
+		 * \param url request URL
+		 * \param transform converts the response into the result, may throw to fail the request
+		 * \param completion receives sucess(bool) and the result, result is default constructed if request or transform failed
+		 * \param body data to send, ignored if empty
+		 * \param content_type content type of the data
+		 * \param headers included headers
+		 */
+		template <typename Transform, typename Completion>
+		bool CreateTransformRequest(const std::string& method, const std::string& url, Transform transform,
+			Completion completion,
+			const std::string& body = "",
+			const std::string& content_type = "application/json",
+			std::vector<std::string> headers = {})
+		{
+			using Result = std::decay_t<std::invoke_result_t<Transform&, Response&>>;
+
+			return CreateTransformRequestInternal(method, url,
+				[transform = std::move(transform), completion = std::move(completion)](bool success, Response& response)
+				-> std::function<void()>
+				{
+					if (!success)
+					{
+						return [completion]() { completion(false, Result{}); };
+					}
+
+					// shared_ptr keeps the closure copyable for move-only results
+					auto result = std::make_shared<Result>(transform(response));
+					return [completion, result]() { completion(true, std::move(*result)); };
+				}, body, content_type, std::move(headers));
+		}
 	private:
+		ARK_API bool CreateTransformRequestInternal(const std::string& method, const std::string& url,
+			const std::function<std::function<void()>(bool, Response&)>& worker,
+			const std::string& body,
+			const std::string& content_type,
+			std::vector<std::string> headers);
+
 		class impl;
 		std::unique_ptr<impl> pimpl;
 	};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "API/Base.h"
+
+struct AActor;
+struct FVector;
+struct UClass;
+
+namespace API
+{
+	/**
+	 * \brief Uniform grid of online player characters and tamed dinos for proximity queries.
+	 * Positions are read once per tick into flat coordinate arrays sorted by cell, so queries see the positions
+	 * of the previous tick. The grid is built on the first query. Must be used from the game thread
+	 */
+	class SpatialGrid
+	{
+	public:
+		enum Kinds : uint8_t
+		{
+			Players = 1 << 0,
+			TamedDinos = 1 << 1,
+			All = Players | TamedDinos
+		};
+
+		ARK_API static SpatialGrid& Get();
+
+		SpatialGrid(const SpatialGrid&) = delete;
+		SpatialGrid(SpatialGrid&&) = delete;
+		SpatialGrid& operator=(const SpatialGrid&) = delete;
+		SpatialGrid& operator=(SpatialGrid&&) = delete;
+
+		/**
+		 * \brief Appends actors within the radius to out. out isn't cleared, so a buffer can be reused between calls
+		 * \param center Center of the sphere
+		 * \param radius Radius
+		 * \param kinds Combination of Kinds
+		 * \param out Receives the actors
+		 * \param exclude Actors which are skipped, can be nullptr
+		 * \return Number of appended actors
+		 */
+		ARK_API size_t QueryRadius(const FVector& center, float radius, uint8_t kinds, std::vector<AActor*>& out,
+		                           const std::unordered_set<AActor*>* exclude = nullptr);
+
+		/**
+		 * \brief Appends actors inside the axis-aligned box to out
+		 */
+		ARK_API size_t QueryBox(const FVector& min, const FVector& max, uint8_t kinds, std::vector<AActor*>& out,
+		                        const std::unordered_set<AActor*>* exclude = nullptr);
+
+	private:
+		struct CellRange
+		{
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		SpatialGrid() = default;
+		~SpatialGrid();
+
+		void Start();
+		void Rebuild();
+
+		void AddActor(AActor* actor, uint8_t kind);
+
+		uint64_t CellKey(float x, float y) const;
+
+		template <typename Func>
+		void ForEachCandidate(float min_x, float min_y, float max_x, float max_y, Func&& func) const;
+
+		float cell_size_{5000.f};
+		bool started_{false};
+
+		UClass* player_class_{nullptr};
+		UClass* dino_class_{nullptr};
+
+		// Entries sorted by cell
+		std::vector<float> xs_;
+		std::vector<float> ys_;
+		std::vector<float> zs_;
+		std::vector<AActor*> actors_;
+		std::vector<uint8_t> kinds_;
+		std::unordered_map<uint64_t, CellRange> cells_;
+
+		// Unsorted entries of the current rebuild
+		std::vector<float> staging_xs_;
+		std::vector<float> staging_ys_;
+		std::vector<float> staging_zs_;
+		std::vector<AActor*> staging_actors_;
+		std::vector<uint8_t> staging_kinds_;
+		std::vector<uint64_t> staging_keys_;
+
+		// Dino teams of the current rebuild
+		std::vector<int> teams_;
+	};
+} // namespace API
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <chrono>
+#include <unordered_map>
 
 #include "API/Base.h"
 
@@ -54,12 +55,13 @@ namespace API
 		{
 			TimerFunc(const std::chrono::time_point<std::chrono::system_clock>& next_time,
 			          std::function<void()> callback,
-			          bool exec_once, int execution_counter, int execution_interval)
+			          bool exec_once, int execution_counter, int execution_interval, HMODULE owner)
 				: next_time(next_time),
 				  callback(move(callback)),
 				  exec_once(exec_once),
 				  execution_counter(execution_counter),
-				  execution_interval(execution_interval)
+				  execution_interval(execution_interval),
+				  owner(owner)
 			{
 			}
 
@@ -68,8 +70,13 @@ namespace API
 			bool exec_once;
 			int execution_counter;
 			int execution_interval;
+
+			// Module which scheduled the task
+			HMODULE owner;
 		};
 
+		friend class PluginStats;
+
 		Timer();
 		~Timer();
 
@@ -79,6 +86,8 @@ namespace API
 
 		void Update();
 
+		void CountTasks(std::unordered_map<HMODULE, size_t>& counts) const;
+
 		std::vector<std::unique_ptr<TimerFunc>> timer_funcs_;
 	};
 } // namespace API
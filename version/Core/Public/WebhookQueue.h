@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "API/Base.h"
+
+namespace API
+{
+	struct Response;
+
+	/**
+	 * \brief Per-endpoint batching and rate limit settings
+	 */
+	struct WebhookSettings
+	{
+		// Messages are merged for this long before the batch is sent
+		int flush_interval_ms{1000};
+
+		// Batch is sent right away once it reaches one of these limits
+		size_t max_batch_messages{20};
+		size_t max_batch_size{1900};
+
+		// Token bucket, burst size and tokens regained per second
+		int bucket_capacity{5};
+		double refill_per_second{1.0};
+
+		// Retries for 429, 5xx and connection errors
+		int max_retries{5};
+		int base_backoff_ms{500};
+		int max_backoff_ms{60000};
+
+		// Pending messages above this count are dropped (oldest first)
+		size_t max_queued_messages{5000};
+
+		std::string content_type{"application/json"};
+		std::vector<std::string> headers;
+
+		/**
+		 * \brief Builds request body from the merged messages. Discord-style {"content": "..."} is used if empty
+		 */
+		std::function<std::string(const std::vector<std::string>&)> build_body;
+	};
+
+	class WebhookQueue
+	{
+	public:
+		ARK_API static WebhookQueue& Get();
+
+		WebhookQueue(const WebhookQueue&) = delete;
+		WebhookQueue(WebhookQueue&&) = delete;
+		WebhookQueue& operator=(const WebhookQueue&) = delete;
+		WebhookQueue& operator=(WebhookQueue&&) = delete;
+
+		/**
+		 * \brief Sets batching and rate limit settings for the endpoint. Must be called before the first Enqueue to take full effect
+		 * \param url Endpoint URL
+		 * \param settings Endpoint settings
+		 */
+		ARK_API void SetEndpointSettings(const std::string& url, const WebhookSettings& settings);
+
+		/**
+		 * \brief Queues a message for the endpoint. Messages are merged with other pending messages of the same endpoint
+		 * and posted from the main thread as a single request
+		 * \param url Endpoint URL
+		 * \param message Message text
+		 */
+		ARK_API void Enqueue(const std::string& url, const std::string& message);
+
+		/**
+		 * \brief Sends all pending batches on the next update, ignoring the flush interval but not the rate limits
+		 */
+		ARK_API void FlushAll();
+
+		/**
+		 * \brief Returns amount of messages waiting to be sent for the endpoint
+		 */
+		ARK_API size_t GetPendingCount(const std::string& url);
+
+		/**
+		 * \brief Returns amount of messages dropped for the endpoint because of queue overflow or exhausted retries
+		 */
+		ARK_API size_t GetDroppedCount(const std::string& url);
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Endpoint
+		{
+			WebhookSettings settings;
+
+			std::deque<std::string> pending;
+			size_t pending_size{0};
+			Clock::time_point first_pending_time;
+
+			// Batch which is being sent or waits for a retry
+			std::vector<std::string> batch;
+			bool in_flight{false};
+			int attempt{0};
+
+			double tokens{0};
+			Clock::time_point last_refill;
+			Clock::time_point blocked_until;
+
+			size_t dropped{0};
+		};
+
+		WebhookQueue();
+		~WebhookQueue();
+
+		void Update();
+
+		Endpoint& GetEndpoint(const std::string& url);
+		void TakeBatch(Endpoint& endpoint);
+		void Send(const std::string& url, Endpoint& endpoint);
+		void OnResponse(const std::string& url, bool success, const Response& response);
+
+		static std::string BuildDefaultBody(const std::vector<std::string>& messages);
+		static int GetRetryAfterMs(const Response& response);
+
+		std::unordered_map<std::string, Endpoint> endpoints_;
+		std::mutex mutex_;
+		bool flush_all_{false};
+	};
+} // namespace API
@@ -2,10 +2,10 @@
 #include <tlhelp32.h>
 #include <cstdio>
 #include <filesystem>
-#include <fstream>
-#include <json.hpp>
 #include "Core/Private/Ark/ArkBaseApi.h"
 #include "Core/Private/Atlas/AtlasBaseApi.h"
+#include "Core/Public/Config.h"
+#include "Core/Public/FlightRecorder.h"
 #include "Core/Public/Logger/Logger.h"
 #include "Core/Public/Tools.h"
 
@@ -51,16 +51,8 @@ DWORD GetParentProcessId()
 
 bool AttachToParent()
 {
-	const std::string config_path = ArkApi::Tools::GetCurrentDir() + "/config.json";
-	std::ifstream file{ config_path };
-	if (!file.is_open())
-		return false;
-
-	nlohmann::json config;
-	file >> config;
-	file.close();
-	
-	return config["settings"].value("AttachToParent", false);
+	return API::Config::Get().GetValue<bool>(ArkApi::Tools::GetCurrentDir() + "/config.json",
+	                                         "/settings/AttachToParent", false);
 }
 
 void OpenConsole()
@@ -164,6 +156,8 @@ void Init()
 
 	Log::Get().Init("API");
 
+	API::FlightRecorder::Get().InstallCrashHandlers();
+
 	const std::string game_name = DetectGame();
 	if (game_name == "Ark")
 		API::game_api = std::make_unique<API::ArkBaseApi>();
@@ -202,6 +196,9 @@ BOOL WINAPI DllMain(HINSTANCE hinst_dll, DWORD fdw_reason, LPVOID /*unused*/)
 	}
 	else if (fdw_reason == DLL_PROCESS_DETACH)
 	{
+		// Other threads are already gone at process exit, the remaining log messages are written from here
+		FlushLogs(0);
+
 		FreeLibrary(m_hinst_dll);
 	}
 